@@ -15,7 +15,7 @@ struct AddressRange {
   bool valid() const { return first <= last; }
   size_t size() const { return last - first + 1; }
   bool contains(Address addr) const { return addr == std::clamp(addr, first, last); }
-  bool overlapsWith(AddressRange range) const { return range.contains(first) || range.contains(last); }
+  bool overlapsWith(AddressRange range) const { return first <= range.last && range.first <= last; }
 
   void expand(Address addr) {
     if (valid()) {
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+
+// ADC and SBC results for every binary sum of accumulator, operand and carry. The low byte is the new accumulator and
+// bit 8 is the carry, tables are selected by the decimal flag so the ALU does not branch on it.
+
+constexpr uint16_t AluCarryBit = 0x100;
+
+constexpr bool decimalCorrectionAndCarry(uint16_t& result) {
+  if ((result & 0x0f) > 0x09) result += 0x06;
+  if ((result & 0xf0) > 0x90) {
+    result += 0x60;
+    return true;
+  }
+  return false;
+}
+
+constexpr uint16_t aluEntry(uint16_t result, bool carry) {
+  return static_cast<uint16_t>((result & 0xff) | (carry ? AluCarryBit : 0));
+}
+
+// sum is accumulator + operand + carry
+constexpr uint16_t addWithCarryResult(uint16_t sum, bool decimal) {
+  if (!decimal) return aluEntry(sum, sum & 0xff00);
+  const bool carry = decimalCorrectionAndCarry(sum);
+  return aluEntry(sum, carry);
+}
+
+// sum is accumulator + inverted operand + carry
+constexpr uint16_t subtractWithBorrowResult(uint16_t sum, bool decimal) {
+  if (!decimal) return aluEntry(sum, sum & 0xff00);
+  sum -= 0x66;
+  const bool carry = decimalCorrectionAndCarry(sum);
+  return aluEntry(sum, carry);
+}
+
+using AluTableType = std::array<std::array<uint16_t, 0x200>, 2>;
+
+constexpr AluTableType AddWithCarryTable = [] {
+  AluTableType tab{};
+  for (uint16_t sum = 0; sum < 0x200; sum++) {
+    tab[false][sum] = addWithCarryResult(sum, false);
+    tab[true][sum] = addWithCarryResult(sum, true);
+  }
+  return tab;
+}();
+
+constexpr AluTableType SubtractWithBorrowTable = [] {
+  AluTableType tab{};
+  for (uint16_t sum = 0; sum < 0x200; sum++) {
+    tab[false][sum] = subtractWithBorrowResult(sum, false);
+    tab[true][sum] = subtractWithBorrowResult(sum, true);
+  }
+  return tab;
+}();
@@ -0,0 +1,27 @@
+#pragma once
+
+#include "commondefs.h"
+
+// Bus timing policies the fused handlers are instantiated with. The fast bus lets handlers touch memory freely and adds
+// table cycles once per instruction. The cycle exact bus spends one cycle per access, including the dummy reads and
+// writes done by NMOS hardware, so memory sees every access at the cycle it happens. The write logging bus is the fast
+// one with every write entered in the write history.
+
+struct FastBus {
+  static constexpr bool CycleExact = false;
+  static constexpr bool LogsWrites = false;
+};
+
+struct CycleExactBus {
+  static constexpr bool CycleExact = true;
+  static constexpr bool LogsWrites = false;
+};
+
+struct WriteLoggingBus {
+  static constexpr bool CycleExact = false;
+  static constexpr bool LogsWrites = true;
+};
+
+enum class BusAccess : uint8_t { Read, Write };
+
+using BusObserver = std::function<void(long cycle, Address, uint8_t value, BusAccess)>;
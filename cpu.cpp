@@ -1,8 +1,9 @@
 #include "cpu.h"
 #include "decodetable.h"
 #include <chrono>
+#include <cstring>
 
-Cpu::Cpu(Memory& memory) : memory(memory) {
+Cpu::Cpu(Memory& memory) : memory(memory), port(memory, [this](AddressRange range) { invalidateCode(range); }) {
 }
 
 void Cpu::prepImpliedOrAccumulatorMode() {
@@ -37,12 +38,12 @@ void Cpu::prepZeroPageYMode() {
 }
 
 void Cpu::prepIndexedIndirectXMode() {
-  effectiveAddress = memory.word(static_cast<uint8_t>((*operandPtr.lo + regs.x)));
+  effectiveAddress = zeroPageWord(static_cast<uint8_t>(*operandPtr.lo + regs.x));
   setEffectiveOperandPtrToAddress();
 }
 
 void Cpu::prepIndirectIndexedYMode() {
-  calculateEffectiveAddress(memory.word(*operandPtr.lo), regs.y);
+  calculateEffectiveAddress(zeroPageWord(*operandPtr.lo), regs.y);
   setEffectiveOperandPtrToAddress();
 }
 
@@ -62,17 +63,17 @@ void Cpu::prepAbsoluteYMode() {
 }
 
 void Cpu::execLDA() {
-  regs.p.computeNZ(regs.a = *effectiveOperandPtr.lo);
+  regs.p.deferNZ(regs.a = *effectiveOperandPtr.lo);
   if (pageBoundaryCrossed) cycles++;
 }
 
 void Cpu::execLDX() {
-  regs.p.computeNZ(regs.x = *effectiveOperandPtr.lo);
+  regs.p.deferNZ(regs.x = *effectiveOperandPtr.lo);
   if (pageBoundaryCrossed) cycles++;
 }
 
 void Cpu::execLDY() {
-  regs.p.computeNZ(regs.y = *effectiveOperandPtr.lo);
+  regs.p.deferNZ(regs.y = *effectiveOperandPtr.lo);
   if (pageBoundaryCrossed) cycles++;
 }
 
@@ -88,125 +89,86 @@ void Cpu::execSTY() {
   *effectiveOperandPtr.lo = regs.y;
 }
 
-static bool decimalCorrectionAndCarry(uint16_t& result) {
-  if ((result & 0x0f) > 0x09) result += 0x06;
-  if ((result & 0xf0) > 0x90) {
-    result += 0x60;
-    return true;
-  }
-  return false;
-}
-
 void Cpu::execADC() {
-  const uint8_t op2 = *effectiveOperandPtr.lo;
-  uint16_t result = regs.a + op2 + static_cast<uint8_t>(regs.p.carry);
-  if (regs.p.decimal) {
-    regs.p.carry = decimalCorrectionAndCarry(result);
-    regs.p.computeNZ(result);
-  } else {
-    regs.p.computeNZC(result);
-  }
-  regs.p.computeV(regs.a, op2, result);
-  regs.a = static_cast<uint8_t>(result);
+  addWithCarry(*effectiveOperandPtr.lo);
   if (pageBoundaryCrossed) cycles++;
 }
 
 void Cpu::execSBC() {
-  const uint8_t op2 = *effectiveOperandPtr.lo ^ 0xff;
-  uint16_t result = regs.a + op2 + static_cast<uint8_t>(regs.p.carry);
-  if (regs.p.decimal) {
-    result -= 0x66;
-    regs.p.carry = decimalCorrectionAndCarry(result);
-    regs.p.computeNZ(result);
-  } else {
-    regs.p.computeNZC(result);
-  }
-  regs.p.computeV(regs.a, op2, result);
-  regs.a = static_cast<uint8_t>(result);
+  subtractWithBorrow(*effectiveOperandPtr.lo);
   if (pageBoundaryCrossed) cycles++;
 }
 
 void Cpu::execINC() {
-  regs.p.computeNZ(++(*effectiveOperandPtr.lo));
+  regs.p.deferNZ(++(*effectiveOperandPtr.lo));
 }
 
 void Cpu::execINX() {
-  regs.p.computeNZ(++regs.x);
+  regs.p.deferNZ(++regs.x);
 }
 
 void Cpu::execINY() {
-  regs.p.computeNZ(++regs.y);
+  regs.p.deferNZ(++regs.y);
 }
 
 void Cpu::execDEC() {
-  regs.p.computeNZ(--(*effectiveOperandPtr.lo));
+  regs.p.deferNZ(--(*effectiveOperandPtr.lo));
 }
 
 void Cpu::execDEX() {
-  regs.p.computeNZ(--regs.x);
+  regs.p.deferNZ(--regs.x);
 }
 
 void Cpu::execDEY() {
-  regs.p.computeNZ(--regs.y);
+  regs.p.deferNZ(--regs.y);
 }
 
 void Cpu::execASL() {
-  auto val = *effectiveOperandPtr.lo;
-  regs.p.carry = val & 0x80;
-  regs.p.computeNZ(*effectiveOperandPtr.lo = static_cast<uint8_t>(val << 1));
+  *effectiveOperandPtr.lo = shiftLeft(*effectiveOperandPtr.lo);
 }
 
 void Cpu::execLSR() {
-  auto val = *effectiveOperandPtr.lo;
-  regs.p.carry = val & 0x01;
-  regs.p.computeNZ(*effectiveOperandPtr.lo = static_cast<uint8_t>(val >> 1));
+  *effectiveOperandPtr.lo = shiftRight(*effectiveOperandPtr.lo);
 }
 
 void Cpu::execROL() {
-  const uint16_t res = static_cast<uint16_t>(*effectiveOperandPtr.lo << 1) | regs.p.carry;
-  regs.p.carry = res & 0x100;
-  regs.p.computeNZ(*effectiveOperandPtr.lo = static_cast<uint8_t>(res));
+  *effectiveOperandPtr.lo = rotateLeft(*effectiveOperandPtr.lo);
 }
 
 void Cpu::execROR() {
-  const uint16_t tmp = *effectiveOperandPtr.lo | (regs.p.carry ? 0x100 : 0x00);
-  regs.p.carry = tmp & 0x01;
-  regs.p.computeNZ(*effectiveOperandPtr.lo = static_cast<uint8_t>(tmp >> 1));
+  *effectiveOperandPtr.lo = rotateRight(*effectiveOperandPtr.lo);
 }
 
 void Cpu::execAND() {
-  regs.p.computeNZ(regs.a &= *effectiveOperandPtr.lo);
+  regs.p.deferNZ(regs.a &= *effectiveOperandPtr.lo);
   if (pageBoundaryCrossed) cycles++;
 }
 
 void Cpu::execORA() {
-  regs.p.computeNZ(regs.a |= *effectiveOperandPtr.lo);
+  regs.p.deferNZ(regs.a |= *effectiveOperandPtr.lo);
   if (pageBoundaryCrossed) cycles++;
 }
 
 void Cpu::execEOR() {
-  regs.p.computeNZ(regs.a ^= *effectiveOperandPtr.lo);
+  regs.p.deferNZ(regs.a ^= *effectiveOperandPtr.lo);
   if (pageBoundaryCrossed) cycles++;
 }
 
 void Cpu::execCMP() {
-  execCompare(regs.a);
+  compare(regs.a, *effectiveOperandPtr.lo);
   if (pageBoundaryCrossed) cycles++;
 }
 
 void Cpu::execCPX() {
-  execCompare(regs.x);
+  compare(regs.x, *effectiveOperandPtr.lo);
 }
 
 void Cpu::execCPY() {
-  execCompare(regs.y);
+  compare(regs.y, *effectiveOperandPtr.lo);
 }
 
 void Cpu::execBIT() {
-  const auto operand = *effectiveOperandPtr.lo;
-  regs.p.zero = !(regs.a & operand);
-  regs.p.negative = operand & 0x80;
-  regs.p.overflow = operand & 0x40;
+  bitTest(*effectiveOperandPtr.lo);
 }
 
 void Cpu::execSED() {
@@ -238,23 +200,23 @@ void Cpu::execCLV() {
 }
 
 void Cpu::execTAX() {
-  regs.p.computeNZ(regs.x = regs.a);
+  regs.p.deferNZ(regs.x = regs.a);
 }
 
 void Cpu::execTXA() {
-  regs.p.computeNZ(regs.a = regs.x);
+  regs.p.deferNZ(regs.a = regs.x);
 }
 
 void Cpu::execTAY() {
-  regs.p.computeNZ(regs.y = regs.a);
+  regs.p.deferNZ(regs.y = regs.a);
 }
 
 void Cpu::execTYA() {
-  regs.p.computeNZ(regs.a = regs.y);
+  regs.p.deferNZ(regs.a = regs.y);
 }
 
 void Cpu::execTSX() {
-  regs.p.computeNZ(regs.x = regs.sp.offset);
+  regs.p.deferNZ(regs.x = regs.sp.offset);
 }
 
 void Cpu::execTXS() {
@@ -266,10 +228,11 @@ void Cpu::execPHA() {
 }
 
 void Cpu::execPLA() {
-  regs.p.computeNZ(regs.a = pull());
+  regs.p.deferNZ(regs.a = pull());
 }
 
 void Cpu::execPHP() {
+  regs.p.resolveNZ();
   push(regs.p);
 }
 
@@ -290,19 +253,19 @@ void Cpu::execBCS() {
 }
 
 void Cpu::execBEQ() {
-  if (regs.p.zero) execBranch();
+  if (regs.p.deferredZero()) execBranch();
 }
 
 void Cpu::execBMI() {
-  if (regs.p.negative) execBranch();
+  if (regs.p.deferredNegative()) execBranch();
 }
 
 void Cpu::execBNE() {
-  if (!regs.p.zero) execBranch();
+  if (!regs.p.deferredZero()) execBranch();
 }
 
 void Cpu::execBPL() {
-  if (!regs.p.negative) execBranch();
+  if (!regs.p.deferredNegative()) execBranch();
 }
 
 void Cpu::execBVC() {
@@ -334,28 +297,40 @@ void Cpu::execRTI() {
 
 void Cpu::execBRK() {
   pushWord(regs.pc + 1);
+  regs.p.resolveNZ();
   push(regs.p | ProcessorStatus::BreakBitMask);
   regs.p.interrupt = true;
   regs.pc = memory.word(CpuAddress::IrqVector);
 }
 
+// an interrupt taken isn't an instruction of any engine, its writes are logged here
+void Cpu::pushInterruptState() {
+  if (writeLog.enabled() && !replaying) {
+    instructionAddress = regs.pc;
+    pushWord<WriteLoggingBus>(regs.pc);
+    push<WriteLoggingBus>(regs.p);
+  } else {
+    pushWord(regs.pc);
+    push(regs.p);
+  }
+}
+
 void Cpu::irq() {
-  pushWord(regs.pc);
-  push(regs.p);
+  pushInterruptState();
   regs.p.interrupt = true;
   regs.pc = memory.word(CpuAddress::IrqVector);
   runLevel = CpuRunLevel::Normal;
 }
 
 void Cpu::nmi() {
-  pushWord(regs.pc);
-  push(regs.p);
+  pushInterruptState();
   regs.p.interrupt = true;
   regs.pc = memory.word(CpuAddress::NmiVector);
   runLevel = CpuRunLevel::Normal;
 }
 
 void Cpu::reset() {
+  port.reset();
   regs.pc = memory.word(CpuAddress::ResetVector);
   regs.a = 0;
   regs.x = 0;
@@ -371,54 +346,543 @@ void Cpu::reset() {
   runLevel = CpuRunLevel::Normal;
 }
 
+void Cpu::changeEngine(CpuEngine engine) {
+  activeEngine = engine;
+  decodeCache.clear();
+  translationCache.clear();
+}
+
+void Cpu::changeVariant(CpuVariant variant) {
+  activeVariant = variant;
+  decodeCache.clear();
+  translationCache.clear();
+}
+
+// memory changed other than by instructions, its pages are reported as written too
+void Cpu::invalidateCode(AddressRange range) {
+  memory.touch(range);
+  decodeCache.invalidate(range);
+  translationCache.invalidate(range);
+}
+
 void Cpu::resetExecutionState() {
   if (state == CpuState::Halted || state == CpuState::Stopped) state = CpuState::Idle;
 }
 
+// scheduled events keep their distance from the current cycle, histories are cleared, not to be called while running
 void Cpu::resetStatistics() {
+  eventScheduler.shift(cycles);
   cycles = 0;
   duration = Duration::zero();
+  nativeRoutineUses.clear();
+  rewindHistory.clear();
+  writeLog.clear();
 }
 
 void Cpu::stopExecution() {
   if (state == CpuState::Running) state = CpuState::Stopping;
+  wakeUp();
 }
 
 void Cpu::execKIL() {
   regs.pc--;
-  state = CpuState::Halted;
+  halt();
 }
 
-void Cpu::execute(bool continuous, Duration period) {
-  state = CpuState::Running;
-  while (state == CpuState::Running) {
-    const auto t0 = PreciseClock::now();
-    pageBoundaryCrossed = false;
-    const auto pcPtr = &memory[regs.pc];
-    operandPtr.lo = &memory[regs.pc + 1];
-    operandPtr.hi = &memory[regs.pc + 2];
-    const auto& entry = DecodeTable[*pcPtr];
-    const auto ins = entry.instruction;
-
-    regs.pc += ins->size;
-
-    (this->*entry.prepareOperands)();
-    (this->*entry.executeInstruction)();
-
-    const auto dc = ins->cycles;
-    const auto t1 = t0 + period * dc;
-    while (PreciseClock::now() < t1) {}
-    cycles += dc;
-    duration += std::chrono::duration_cast<Duration>(PreciseClock::now() - t0);
-
-    switch (runLevel) {
-    case CpuRunLevel::Normal: break;
-    case CpuRunLevel::PendingReset: reset(); break;
-    case CpuRunLevel::PendingNmi: nmi(); break;
-    case CpuRunLevel::PendingIrq: irq(); break;
+template <CpuVariant Variant>
+void Cpu::stepDecoded() {
+  pageBoundaryCrossed = false;
+  deviceOperand = false;
+  const auto pcPtr = &memory[regs.pc];
+  operandPtr.lo = &memory[regs.pc + 1];
+  operandPtr.hi = &memory[regs.pc + 2];
+  const auto& entry = DecodeTable<Variant>[*pcPtr];
+
+  regs.pc += entry.instruction->size;
+
+  (this->*entry.prepareOperands)();
+  if (deviceOperand) {
+    regs.pc -= entry.instruction->size;
+    stepThreaded<Variant>();
+    return;
+  }
+  (this->*entry.executeInstruction)();
+  if (entry.writesOperand) memory.touch(effectiveAddress);
+
+  cycles += entry.instruction->cycles;
+}
+
+template <CpuVariant Variant, class Bus>
+void Cpu::stepThreaded() {
+  if constexpr (Bus::CycleExact || Bus::LogsWrites) instructionAddress = regs.pc;
+  (this->*OpCodeTable<Variant, Bus>[memory[regs.pc]])();
+}
+
+// instantiated for the interpreter fallback of recompiled code
+template void Cpu::stepThreaded<CpuVariant::Nmos>();
+
+// tables of the active variant are passed in, so the decoder is shared by all of them
+const DecodedInstruction& Cpu::predecode(Address addr, const Instruction* instructions,
+                                         const SequenceHandler* handlers) {
+  const auto decodeSequence = [&](const uint8_t* opCodes, uint8_t length, SequenceHandler handler) {
+    DecodedInstruction entry{handler};
+    int operandBits = 0;
+    for (int i = 0, pc = addr; i < length; i++) {
+      if (pc >= static_cast<int>(Memory::Size) || memory[static_cast<Address>(pc)] != opCodes[i]) return false;
+      const auto& ins = instructions[opCodes[i]];
+      if (pc + ins.size > static_cast<int>(Memory::Size)) return false;
+      for (int j = 1; j < ins.size; j++, operandBits += 8)
+        entry.operands |= static_cast<uint32_t>(memory[static_cast<Address>(pc + j)]) << operandBits;
+      entry.size += ins.size;
+      entry.cycles += ins.cycles;
+      pc += ins.size;
+    }
+    decodeCache.insert(addr, entry);
+    return true;
+  };
+
+  for (const auto& rule : FusionRules)
+    if (decodeSequence(rule.opCodes.data(), rule.length, rule.handler)) return decodeCache[addr];
+
+  const auto opCode = memory[addr];
+  decodeSequence(&opCode, 1, handlers[opCode]);
+  return decodeCache[addr];
+}
+
+template <CpuVariant Variant>
+void Cpu::stepPredecoded() {
+  const auto& entry = decodeCache[regs.pc].handler ? decodeCache[regs.pc] : predecode(regs.pc, instructionTable(Variant).data(), SequenceHandlerTable<Variant>.data());
+  // a fused sequence must not run past an event
+  if (cycles + entry.cycles > eventHorizon) {
+    stepThreaded<Variant>();
+    return;
+  }
+  // the entry may be invalidated by the instruction itself
+  cycles += entry.cycles;
+  (this->*entry.handler)(entry.operands);
+}
+
+template <CpuVariant Variant>
+void Cpu::stepTranslated() {
+  translationCache.purge();
+  auto block = translationCache.find(regs.pc);
+  if (!block && translationCache.hot(regs.pc)) {
+    if (auto translated =
+            translateBlock(regs.pc, instructionTable(Variant).data(), InstructionHandlerTable<Variant>.data())) {
+      block = translated.get();
+      translationCache.insert(std::move(translated));
+    } else {
+      translationCache.markUntranslatable(regs.pc);
+    }
+  }
+  if (!block) {
+    stepPredecoded<Variant>();
+    return;
+  }
+  if (block->routine && highLevelEmulationEnabled && runNativeRoutine(*block->routine)) return;
+  // near an event the block is stepped one instruction at a time, so that the event comes at the right cycle
+  if (cycles + block->cycles > eventHorizon) {
+    stepThreaded<Variant>();
+    return;
+  }
+
+  for (const auto& ti : block->instructions) {
+    (this->*ti.handler)(ti.operand);
+    if (!block->valid) {
+      // the block has overwritten its own code, account for executed part only
+      cycles += ti.elapsedCycles;
+      return;
+    }
+  }
+  cycles += block->cycles;
+}
+
+static bool endsBlock(InstructionType type) {
+  switch (type) {
+  case BCC:
+  case BCS:
+  case BEQ:
+  case BMI:
+  case BNE:
+  case BPL:
+  case BVC:
+  case BVS:
+  case BRA:
+  case JMP:
+  case JSR:
+  case RTS: return true;
+  default: return false;
+  }
+}
+
+std::unique_ptr<TranslatedBlock> Cpu::translateBlock(Address first, const Instruction* instructions,
+                                                     const InstructionHandler* handlers) const {
+  auto block = std::make_unique<TranslatedBlock>();
+  block->first = first;
+  for (int pc = first; block->instructions.size() < TranslationCache::MaxInstructions;) {
+    const auto opCode = memory[static_cast<Address>(pc)];
+    const auto& ins = instructions[opCode];
+    if (ins.type == KIL || ins.type == BRK || ins.type == RTI || ins.type == HCL || pc + ins.size > static_cast<int>(Memory::Size)) break;
+
+    uint16_t operand = 0;
+    if (ins.size == 2) operand = memory[static_cast<Address>(pc + 1)];
+    if (ins.size == 3) operand = memory.word(static_cast<Address>(pc + 1));
+    block->cycles += ins.cycles;
+    block->instructions.push_back({handlers[opCode], operand, static_cast<uint16_t>(block->cycles)});
+    block->last = static_cast<Address>(pc + ins.size - 1);
+    pc += ins.size;
+    if (endsBlock(ins.type)) break;
+  }
+  if (block->instructions.empty()) return nullptr;
+  block->routine = recogniseNativeRoutine(memory, {block->first, block->last}, instructions);
+  return block;
+}
+
+// Runs remaining iterations of recognised loop at once, provided the index doesn't wrap around and no store changes
+// memory read or written later by other transfers, own source when copying in the opposite direction, pointers or
+// the loop itself. Otherwise the loop isn't equivalent to memmove and memset and is left to the interpreter.
+bool Cpu::runNativeRoutine(const NativeRoutine& routine) {
+  uint8_t& index = routine.indexY ? regs.y : regs.x;
+  const uint8_t end = routine.compare ? routine.limit : 0;
+  const int count = (routine.increment ? static_cast<uint8_t>(end - index - 1) : static_cast<uint8_t>(index - end - 1)) + 1;
+  const int lowest = routine.increment ? index : index - count + 1;
+  if (lowest < 0 || lowest + count > 0x100) return false;
+
+  struct Area {
+    AddressRange source;
+    AddressRange destination;
+    int sourceLow; // of the base address, for page crossing of the load
+  };
+  const auto baseAddress = [this](OperandsFormat mode, uint16_t operand) {
+    return mode == IndirectIndexedY ? zeroPageWord(static_cast<uint8_t>(operand)) : operand;
+  };
+  const auto area = [&](OperandsFormat mode, uint16_t operand) {
+    const int first = baseAddress(mode, operand) + lowest;
+    return first + count - 1 <= 0xffff ? AddressRange(static_cast<Address>(first), static_cast<Address>(first + count - 1))
+                                      : AddressRange::Invalid;
+  };
+
+  std::vector<Area> areas;
+  AddressRange pointers;
+  for (const auto& t : routine.transfers) {
+    const bool copy = t.sourceMode != ImpliedOrAccumulator;
+    areas.push_back({copy ? area(t.sourceMode, t.source) : AddressRange::Invalid, area(t.destinationMode, t.destination),
+                     t.load ? baseAddress(t.sourceMode, t.source) & 0xff : 0});
+    if ((copy && !areas.back().source.valid()) || !areas.back().destination.valid()) return false;
+    for (const auto& [mode, operand] : {std::pair(t.sourceMode, t.source), std::pair(t.destinationMode, t.destination)}) {
+      if (mode == IndirectIndexedY) {
+        pointers.expand(static_cast<uint8_t>(operand));
+        pointers.expand(static_cast<uint8_t>(operand + 1));
+      }
+    }
+  }
+  for (size_t k = 0; k < areas.size(); k++) {
+    const auto& dst = areas[k].destination;
+    if (dst.overlapsWith(routine.code) || (pointers.valid() && dst.overlapsWith(pointers))) return false;
+    for (size_t j = 0; j < areas.size(); j++) {
+      const auto& src = areas[j].source;
+      if (j != k && (dst.overlapsWith(areas[j].destination) || (src.valid() && dst.overlapsWith(src)))) return false;
+      if (j == k && src.valid() && dst.overlapsWith(src) && (routine.increment ? dst.first > src.first : dst.first < src.first))
+        return false;
+    }
+  }
+
+  // devices see each access of the interpreted loop
+  for (const auto& a : areas)
+    if (memory.deviceIn(a.destination) || memory.deviceIn(a.source)) return false;
+
+  // loads pay page crossing, index values from threshold on cross it
+  long elapsed = routine.iterationCycles * count - routine.branchTakenCycles;
+  for (const auto& a : areas) {
+    if (a.sourceLow) elapsed += std::max(0, lowest + count - std::max(lowest, 0x100 - a.sourceLow));
+  }
+  // events due in the middle of the loop are met by the interpreter
+  if (cycles + elapsed > eventHorizon) return false;
+
+  const int lastIndex = routine.increment ? lowest + count - 1 : lowest;
+  for (auto it = areas.rbegin(); it != areas.rend(); it++) {
+    if (it->source.valid()) {
+      regs.a = memory[static_cast<Address>(it->source.first - lowest + lastIndex)];
+      break;
+    }
+  }
+  const auto type = routine.type(regs.a);
+  for (const auto& a : areas) {
+    if (a.source.valid()) {
+      std::memmove(&memory[a.destination.first], &memory[a.source.first], a.destination.size());
+    } else {
+      std::memset(&memory[a.destination.first], regs.a, a.destination.size());
+    }
+    invalidateCode(a.destination);
+  }
+
+  index = end;
+  if (routine.compare) {
+    compare(index, routine.limit);
+  } else {
+    regs.p.deferNZ(index);
+  }
+  regs.pc = static_cast<Address>(routine.code.last + 1);
+  cycles += elapsed;
+
+  auto& use = nativeRoutineUses.try_emplace(routine.code.first, NativeRoutineUse{routine.code, type, 0, 0, 0}).first->second;
+  use.type = type;
+  use.runs++;
+  use.bytes += count * static_cast<long>(areas.size());
+  use.cycles += elapsed;
+  return true;
+}
+
+std::vector<NativeRoutineUse> Cpu::replacedRoutines() const {
+  std::vector<NativeRoutineUse> uses;
+  for (const auto& [address, use] : nativeRoutineUses) uses.push_back(use);
+  return uses;
+}
+
+// HCL #n has moved past itself already, calls of unregistered services step back onto it as KIL does
+void Cpu::hostCall(uint8_t service) {
+  regs.p.resolveNZ();
+  HostCall call{regs, memory, {}};
+  if (hostServiceTable.call(service, call)) {
+    cycles += hostServiceTable.cost(service);
+    if (call.written.valid()) invalidateCode(call.written);
+  } else {
+    regs.pc -= 2;
+    halt();
+  }
+  regs.p.deferCurrentNZ();
+}
+
+void Cpu::handleRunLevel() {
+  // interrupt or reset requested from outside, states before it say nothing about the loop after it
+  hangDetector.reset();
+  if (runLevel == CpuRunLevel::PendingNmi || runLevel == CpuRunLevel::PendingIrq) rewindHistory.addInterrupt(cycles, runLevel);
+  if (runLevel != CpuRunLevel::Normal) recordInput(inputKind(runLevel));
+  regs.p.resolveNZ();
+  switch (runLevel) {
+  case CpuRunLevel::Normal: break;
+  case CpuRunLevel::PendingReset: reset(); break;
+  case CpuRunLevel::PendingNmi: nmi(); break;
+  case CpuRunLevel::PendingIrq: irq(); break;
+  }
+  regs.p.deferCurrentNZ();
+}
+
+// instructions a loop waiting for an interrupt can consist of: no memory or stack writes, no subroutines
+static bool withoutSideEffects(const Instruction& ins) {
+  switch (ins.type) {
+  case LDA:
+  case LDX:
+  case LDY:
+  case LAX:
+  case ADC:
+  case SBC:
+  case AND:
+  case ORA:
+  case EOR:
+  case CMP:
+  case CPX:
+  case CPY:
+  case BIT:
+  case ANC:
+  case ALR:
+  case ARR:
+  case SBX:
+  case INX:
+  case INY:
+  case DEX:
+  case DEY:
+  case SED:
+  case SEI:
+  case SEC:
+  case CLC:
+  case CLD:
+  case CLI:
+  case CLV:
+  case TAX:
+  case TXA:
+  case TAY:
+  case TYA:
+  case TSX:
+  case TXS:
+  case BCC:
+  case BCS:
+  case BEQ:
+  case BMI:
+  case BNE:
+  case BPL:
+  case BVC:
+  case BVS:
+  case BRA:
+  case JMP:
+  case NOP: return true;
+  case ASL:
+  case LSR:
+  case ROL:
+  case ROR:
+  case INC:
+  case DEC: return ins.mode == ImpliedOrAccumulator;
+  default: return false;
+  }
+}
+
+static bool sameState(Registers r1, Registers r2) {
+  r1.p.resolveNZ();
+  r2.p.resolveNZ();
+  return r1.a == r2.a && r1.x == r2.x && r1.y == r2.y && r1.pc == r2.pc && r1.sp.offset == r2.sp.offset &&
+         static_cast<uint8_t>(r1.p) == static_cast<uint8_t>(r2.p);
+}
+
+// Executes instructions from pc until it comes back there and returns the number of cycles it took if the loop can't
+// end by itself: registers are the same and nothing has been written, so the next iteration is the same again.
+// Returns 0 otherwise, also when the limit is reached meanwhile or a device has been read, as it may return something
+// else next time.
+template <CpuVariant Variant>
+long Cpu::probeIdleLoop(long limit) {
+  const auto start = regs;
+  const auto c0 = cycles;
+  const auto deviceAccesses = memory.deviceAccesses();
+  for (int i = 0; i < MaxIdleLoopLength && runLevel == CpuRunLevel::Normal && state == CpuState::Running && cycles < limit;
+       i++) {
+    if (!withoutSideEffects(instructionTable(Variant)[memory[regs.pc]])) return 0;
+    stepThreaded<Variant>();
+    if (regs.pc == start.pc)
+      return sameState(regs, start) && memory.deviceAccesses() == deviceAccesses ? cycles - c0 : 0;
+  }
+  return 0;
+}
+
+// Skips whole iterations of the idle loop which end before the limit, the rest is left to the interpreter so that the
+// limit is met exactly. Without limit it blocks until an interrupt, reset or stop request comes. A throttled run waits
+// for the time the skipped iterations would take, an unthrottled one skips them at once. Returns the time spent waiting.
+Duration Cpu::waitInIdleLoop(long loopCycles, Duration period, long limit) {
+  const auto iterations = limit == EventScheduler::Never ? limit : std::max(0L, (limit - cycles) / loopCycles);
+  if (period == Duration::zero() && limit != EventScheduler::Never) {
+    cycles += iterations * loopCycles;
+    return Duration::zero();
+  }
+  const auto t0 = PreciseClock::now();
+  {
+    const auto request = [this] { return runLevel != CpuRunLevel::Normal || state != CpuState::Running; };
+    std::unique_lock<std::mutex> lock(idleMutex);
+    if (limit == EventScheduler::Never)
+      idleWakeUp.wait(lock, request);
+    else
+      idleWakeUp.wait_until(lock, t0 + period * (iterations * loopCycles), request);
+  }
+  const auto waited = std::chrono::duration_cast<Duration>(PreciseClock::now() - t0);
+  if (period != Duration::zero()) cycles += std::min<long>(waited / (period * loopCycles), iterations) * loopCycles;
+  return waited;
+}
+
+// Makes the run loop leave stepping after the current instruction and wakes it from an idle loop
+void Cpu::wakeUp() {
+  eventHorizon = 0;
+  std::lock_guard<std::mutex> lock(idleMutex);
+  idleWakeUp.notify_all();
+}
+
+EventId Cpu::scheduleEvent(long cycle, EventHandler handler) {
+  eventHorizon = std::min(eventHorizon, cycle);
+  return eventScheduler.schedule(cycle, std::move(handler));
+}
+
+// Events due and requests made are dealt with between instructions. In between the engines step without checking
+// anything but the event horizon: the next event, the limit or the next idle loop check, whichever comes first.
+// Requests from other threads pull the horizon down to 0.
+template <CpuVariant Variant, Cpu::Handler Step, bool SkipIdleLoops>
+void Cpu::run(bool continuous, Duration period, long limit) {
+  auto idleCheck = SkipIdleLoops && continuous ? cycles + IdleCheckInterval : EventScheduler::Never;
+  // unthrottled, clock is read once per run instead of once per instruction
+  auto t0 = PreciseClock::now();
+  auto stepped = false;
+  for (;;) {
+    eventScheduler.dispatch(cycles);
+    // before interrupts, those at the checkpoint cycle are replayed from the history
+    if (cycles >= rewindHistory.nextCheckpoint()) {
+      auto resolved = regs;
+      resolved.p.resolveNZ();
+      rewindHistory.addCheckpoint(takeSnapshot(resolved));
     }
-    if (!continuous) break;
+    if (cycles >= inputRecord.nextCycle()) applyDueInputs();
+    if (runLevel != CpuRunLevel::Normal) handleRunLevel();
+    if (state != CpuState::Running || cycles >= limit || (stepped && !continuous)) break;
+
+    if (cycles >= idleCheck) {
+      const auto until = std::min({limit, eventScheduler.nextCycle(), inputRecord.nextCycle()});
+      if (const auto loopCycles = probeIdleLoop<Variant>(until)) {
+        const auto waited = waitInIdleLoop(loopCycles, period, until);
+        // time spent waiting doesn't count as cycles don't advance
+        if (period == Duration::zero()) t0 += waited;
+        else duration += waited;
+      }
+      idleCheck = cycles + IdleCheckInterval;
+      continue;
+    }
+
+    eventHorizon =
+        std::min({limit, eventScheduler.nextCycle(), idleCheck, rewindHistory.nextCheckpoint(), inputRecord.nextCycle()});
+    // single step, or a request came before the horizon was set
+    if (!continuous || runLevel != CpuRunLevel::Normal || state != CpuState::Running) eventHorizon = 0;
+
+    if (period == Duration::zero()) {
+      do (this->*Step)();
+      while (cycles < eventHorizon);
+    } else {
+      const auto t1 = PreciseClock::now();
+      const auto c1 = cycles;
+      (this->*Step)();
+      const auto t2 = t1 + period * (cycles - c1);
+      while (PreciseClock::now() < t2) {}
+      duration += std::chrono::duration_cast<Duration>(PreciseClock::now() - t1);
+    }
+    stepped = true;
+  }
+  if (period == Duration::zero()) duration += std::chrono::duration_cast<Duration>(PreciseClock::now() - t0);
+}
+
+template <CpuVariant Variant>
+void Cpu::runVariant(bool continuous, Duration period, long limit) {
+  // writes are logged by the interpreter on a bus of its own, the cycle exact one logs them as bus cycles
+  if (writeLog.enabled() && activeEngine != CpuEngine::CycleExact) {
+    run<Variant, &Cpu::stepThreaded<Variant, WriteLoggingBus>>(continuous, period, limit);
+    return;
+  }
+  switch (activeEngine) {
+  case CpuEngine::Decoded: run<Variant, &Cpu::stepDecoded<Variant>>(continuous, period, limit); break;
+  case CpuEngine::Threaded: run<Variant, &Cpu::stepThreaded<Variant>>(continuous, period, limit); break;
+  case CpuEngine::Predecoded:
+    if (continuous) {
+      run<Variant, &Cpu::stepPredecoded<Variant>>(continuous, period, limit);
+    } else {
+      run<Variant, &Cpu::stepThreaded<Variant>>(continuous, period, limit);
+    }
+    break;
+  case CpuEngine::Translated:
+    if (continuous) {
+      run<Variant, &Cpu::stepTranslated<Variant>>(continuous, period, limit);
+    } else {
+      run<Variant, &Cpu::stepThreaded<Variant>>(continuous, period, limit);
+    }
+    break;
+  case CpuEngine::CycleExact:
+    // skipping idle loops would skip their bus accesses
+    run<Variant, &Cpu::stepThreaded<Variant, CycleExactBus>, false>(continuous, period, limit);
+    break;
   }
+}
+
+void Cpu::executeWithLimit(bool continuous, Duration period, long limit) {
+  lastHangReport.reset();
+  regs.p.deferCurrentNZ();
+  state = CpuState::Running;
+  switch (activeVariant) {
+  case CpuVariant::Nmos: runVariant<CpuVariant::Nmos>(continuous, period, limit); break;
+  case CpuVariant::NmosUndocumented: runVariant<CpuVariant::NmosUndocumented>(continuous, period, limit); break;
+  case CpuVariant::Cmos65C02: runVariant<CpuVariant::Cmos65C02>(continuous, period, limit); break;
+  }
+  regs.p.resolveNZ();
+  if (hangCheckInterval && state == CpuState::Halted) lastHangReport = HangReport{HangCause::Halted, regs.pc, cycles, 0};
   switch (state) {
   case CpuState::Running: state = CpuState::Idle; break;
   case CpuState::Stopping: state = CpuState::Stopped; break;
@@ -426,12 +890,253 @@ void Cpu::execute(bool continuous, Duration period) {
   }
 }
 
+void Cpu::changeHangDetection(long interval) {
+  if (hangCheckEvent) eventScheduler.cancel(hangCheckEvent);
+  hangCheckEvent = 0;
+  hangCheckInterval = interval;
+  hangDetector.reset();
+  dispatchedAtHangCheck = eventScheduler.dispatched();
+  deviceAccessesAtHangCheck = memory.deviceAccesses();
+  if (interval > 0) hangCheckEvent = scheduleEvent(cycles + interval, [this](long) { checkHang(); });
+}
+
+// Samples the machine state for the hang detector every interval cycles, counted from the instruction the check comes
+// at, so that the check cycles depend on the state only. The run isn't determined by the state alone when other events
+// have come since the last check or are pending, or when devices have been read or remapped.
+void Cpu::checkHang() {
+  if (!eventScheduler.empty() || eventScheduler.dispatched() != dispatchedAtHangCheck + 1 ||
+      memory.deviceAccesses() != deviceAccessesAtHangCheck)
+    hangDetector.reset();
+  if (const auto loopCycles = hangDetector.sample(regs, memory, cycles)) {
+    lastHangReport = HangReport{HangCause::Loop, traceLoop(loopCycles), cycles, loopCycles};
+    hangDetector.reset();
+    stopExecution();
+  }
+  hangCheckEvent = scheduleEvent(cycles + hangCheckInterval, [this](long) { checkHang(); });
+  dispatchedAtHangCheck = eventScheduler.dispatched();
+  deviceAccessesAtHangCheck = memory.deviceAccesses();
+}
+
+// Runs the loop once more to find out which instructions it consists of, it ends in the same state as it starts
+AddressRange Cpu::traceLoop(long loopCycles) {
+  const auto c0 = cycles;
+  AddressRange range;
+  while (cycles - c0 < loopCycles) {
+    range.expand(regs.pc);
+    switch (activeVariant) {
+    case CpuVariant::Nmos: stepThreaded<CpuVariant::Nmos>(); break;
+    case CpuVariant::NmosUndocumented: stepThreaded<CpuVariant::NmosUndocumented>(); break;
+    case CpuVariant::Cmos65C02: stepThreaded<CpuVariant::Cmos65C02>(); break;
+    }
+  }
+  cycles = c0;
+  return range;
+}
+
+Snapshot Cpu::takeSnapshot() {
+  return takeSnapshot(registers());
+}
+
+// Pages written since the last snapshot get copied, the others are shared with it. Registers are given with N and Z
+// resolved, they are deferred while running.
+Snapshot Cpu::takeSnapshot(const Registers& saved) {
+  const auto changed = memory.changedPages(snapshotGeneration);
+  for (size_t page = 0; page < Memory::NumberOfPages; page++) {
+    if (snapshotPages[page] && !changed[page]) continue;
+    auto copy = std::make_shared<Snapshot::Page>();
+    std::copy_n(memory.begin() + page * Memory::PageSize, Memory::PageSize, copy->begin());
+    snapshotPages[page] = std::move(copy);
+  }
+  snapshotGeneration = memory.startGeneration();
+  return {saved, state, runLevel, cycles, snapshotPages, port.state()};
+}
+
+// Only pages which differ from the snapshot are copied back, they count as written. Must not be called while running.
+// writes done after the snapshot are no longer part of the run
+void Cpu::restoreSnapshot(const Snapshot& snapshot) {
+  restoreState(snapshot);
+  writeLog.truncate(snapshot.cycles);
+}
+
+void Cpu::restoreState(const Snapshot& snapshot) {
+  const auto changed = memory.changedPages(snapshotGeneration);
+  for (size_t page = 0; page < Memory::NumberOfPages; page++) {
+    if (snapshotPages[page] == snapshot.pages[page] && !changed[page]) continue;
+    const auto first = static_cast<Address>(page * Memory::PageSize);
+    std::copy(snapshot.pages[page]->begin(), snapshot.pages[page]->end(), memory.begin() + first);
+    invalidateCode({first, static_cast<Address>(first + Memory::PageSize - 1)});
+  }
+  port.restore(snapshot.port);
+  snapshotPages = snapshot.pages;
+  snapshotGeneration = memory.startGeneration();
+  regs = snapshot.regs;
+  state = snapshot.state == CpuState::Halted ? CpuState::Halted : CpuState::Idle;
+  runLevel = snapshot.runLevel;
+  cycles = snapshot.cycles;
+  hangDetector.reset();
+}
+
+// Goes back to the start of the previous instruction, the run is executed again from the checkpoint before it
+bool Cpu::stepBack() {
+  const auto now = cycles;
+  const auto checkpoint = rewindHistory.checkpointBefore(now);
+  if (running() || inputRecord.mode() != InputLog::Mode::Off || !checkpoint) return false;
+  auto previous = checkpoint->cycles;
+  restoreCheckpoint(*checkpoint);
+  replay(now, [&] { previous = cycles; });
+  rewindTo(*checkpoint, previous);
+  return true;
+}
+
+// Goes back to the last time an instruction at the address was about to be executed, checkpoint by checkpoint.
+// Stays where it is if there is no such time in the history.
+bool Cpu::runBackTo(Address address) {
+  if (running() || inputRecord.mode() != InputLog::Mode::Off) return false;
+  const auto current = takeSnapshot();
+  auto end = cycles;
+  while (const auto checkpoint = rewindHistory.checkpointBefore(end)) {
+    auto found = -1L;
+    restoreCheckpoint(*checkpoint);
+    replay(end, [&] {
+      if (regs.pc == address) found = cycles;
+    });
+    if (found >= 0) {
+      rewindTo(*checkpoint, found);
+      return true;
+    }
+    end = checkpoint->cycles;
+  }
+  restoreSnapshot(current);
+  return false;
+}
+
+// interrupts pending at the checkpoint come from the history
+void Cpu::restoreCheckpoint(const Snapshot& checkpoint) {
+  restoreState(checkpoint);
+  runLevel = CpuRunLevel::Normal;
+}
+
+void Cpu::rewindTo(const Snapshot& checkpoint, long cycle) {
+  restoreCheckpoint(checkpoint);
+  replay(cycle, [] {});
+  rewindHistory.truncate(cycle);
+  writeLog.truncate(cycle);
+}
+
+template <class Visit>
+void Cpu::replay(long until, Visit visit) {
+  // writes done again are in the write history already
+  replaying = true;
+  switch (activeVariant) {
+  case CpuVariant::Nmos: replayVariant<CpuVariant::Nmos>(until, visit); break;
+  case CpuVariant::NmosUndocumented: replayVariant<CpuVariant::NmosUndocumented>(until, visit); break;
+  case CpuVariant::Cmos65C02: replayVariant<CpuVariant::Cmos65C02>(until, visit); break;
+  }
+  replaying = false;
+}
+
+// Executes the run again up to the instruction starting at the cycle, taking interrupts at the cycles they were taken
+// at. Visit is called at the start of each instruction, before interrupts. An interrupt due at the end is left pending.
+// Events aren't dispatched, whatever their handlers did to devices and memory isn't repeated.
+template <CpuVariant Variant, class Visit>
+void Cpu::replayVariant(long until, Visit visit) {
+  auto interrupt = rewindHistory.interruptsFrom(cycles);
+  regs.p.deferCurrentNZ();
+  while (cycles < until && state != CpuState::Halted) {
+    visit();
+    for (; interrupt != rewindHistory.interruptsEnd() && interrupt->cycle <= cycles; interrupt++) {
+      regs.p.resolveNZ();
+      if (interrupt->runLevel == CpuRunLevel::PendingNmi)
+        nmi();
+      else
+        irq();
+      regs.p.deferCurrentNZ();
+    }
+    stepThreaded<Variant>();
+  }
+  regs.p.resolveNZ();
+  if (interrupt != rewindHistory.interruptsEnd() && interrupt->cycle == cycles) runLevel = interrupt->runLevel;
+}
+
+// Starts a new log, memory is expected to have been filled from the seed and the CPU reset just before
+void Cpu::recordInputs(uint32_t seed) {
+  inputRecord.startRecording(seed);
+  memory.filterDeviceReads([this](Address address, uint8_t value) {
+    recordInput(InputKind::DeviceRead, address, value);
+    return value;
+  });
+}
+
+// Starts from the same state the log was recorded from, inputs due now are applied at once
+void Cpu::replayInputs(InputLog log) {
+  inputRecord = std::move(log);
+  inputRecord.startReplay();
+  memory.filterDeviceReads(
+      [this](Address address, uint8_t value) { return inputRecord.nextDeviceRead(address).value_or(value); });
+  applyDueInputs();
+}
+
+void Cpu::stopInputLog() {
+  inputRecord.stop();
+  memory.filterDeviceReads({});
+}
+
+void Cpu::recordInput(InputKind kind, Address address, uint16_t value, Data bytes) {
+  inputRecord.add({cycles, kind, address, value, std::move(bytes)});
+}
+
+// Requests are taken at once as they were taken between instructions, not when they were made
+void Cpu::applyInput(const Input& input) {
+  switch (input.kind) {
+  case InputKind::Reset:
+  case InputKind::Nmi:
+  case InputKind::Irq: {
+    const auto level = runLevelOf(input.kind);
+    if (running()) {
+      runLevel = std::max(runLevel, level);
+      handleRunLevel();
+    } else if (level == CpuRunLevel::PendingReset)
+      reset();
+    else if (level == CpuRunLevel::PendingNmi)
+      nmi();
+    else
+      irq();
+    break;
+  }
+  case InputKind::ProgramCounter: regs.pc = input.value; break;
+  case InputKind::StackPointer: regs.sp.offset = static_cast<uint8_t>(input.value); break;
+  case InputKind::Accumulator: regs.a = static_cast<uint8_t>(input.value); break;
+  case InputKind::RegisterX: regs.x = static_cast<uint8_t>(input.value); break;
+  case InputKind::RegisterY: regs.y = static_cast<uint8_t>(input.value); break;
+  case InputKind::Memory: {
+    const auto size = std::min(input.bytes.size(), Memory::Size - input.address);
+    if (!size) break;
+    std::copy_n(input.bytes.begin(), size, memory.begin() + input.address);
+    invalidateCode({input.address, static_cast<Address>(input.address + size - 1)});
+    break;
+  }
+  case InputKind::DeviceRead: break;
+  }
+}
+
+void Cpu::execute(bool continuous, Duration period) {
+  executeWithLimit(continuous, period, EventScheduler::Never);
+}
+
+// Runs until the cycle count reaches given cycle, the first instruction ending at or after it is the last one
+void Cpu::executeUntil(long cycle, Duration period) {
+  executeWithLimit(true, period, cycle);
+}
+
 void Cpu::triggerReset() {
   if (runLevel < CpuRunLevel::PendingReset) {
     if (running()) {
       runLevel = CpuRunLevel::PendingReset;
-    } else
+      wakeUp();
+    } else {
+      recordInput(InputKind::Reset);
       reset();
+    }
   }
 }
 
@@ -439,7 +1144,9 @@ void Cpu::triggerNmi() {
   if (runLevel < CpuRunLevel::PendingNmi) {
     if (running()) {
       runLevel = CpuRunLevel::PendingNmi;
+      wakeUp();
     } else {
+      recordInput(InputKind::Nmi);
       nmi();
     }
   }
@@ -449,7 +1156,9 @@ void Cpu::triggerIrq() {
   if (runLevel < CpuRunLevel::PendingIrq && !regs.p.interrupt) {
     if (running()) {
       runLevel = CpuRunLevel::PendingIrq;
+      wakeUp();
     } else {
+      recordInput(InputKind::Irq);
       irq();
     }
   }
@@ -458,3 +1167,9 @@ void Cpu::triggerIrq() {
 CpuInfo Cpu::info() const {
   return {runLevel, state, {cycles, duration}};
 }
+
+Registers Cpu::registers() const {
+  auto copy = regs;
+  if (running()) copy.p.resolveNZ();
+  return copy;
+}
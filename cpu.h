@@ -1,67 +1,198 @@
 #pragma once
 
+#include "addressrange.h"
+#include "alutable.h"
+#include "buspolicy.h"
+#include "cpucore.h"
+#include "cpuengine.h"
 #include "cpuinfo.h"
 #include "cpustate.h"
+#include "cpuvariant.h"
+#include "decodecache.h"
+#include "eventscheduler.h"
+#include "hangdetector.h"
+#include "hostservices.h"
+#include "inputlog.h"
 #include "instruction.h"
 #include "memory.h"
-#include "operandptr.h"
-#include "registers.h"
-#include "runlevel.h"
+#include "nativeroutine.h"
+#include "processorport.h"
+#include "rewindhistory.h"
+#include "snapshot.h"
+#include "translationcache.h"
+#include "writehistory.h"
+#include <array>
 #include <atomic>
 #include <chrono>
 #include <commondefs.h>
+#include <condition_variable>
 #include <map>
+#include <mutex>
+#include <optional>
+#include <utility>
 
-class Cpu {
+class Cpu : private CpuCore {
 public:
   using Handler = void (Cpu::*)();
+  using InstructionHandler = void (Cpu::*)(uint16_t);
+  using SequenceHandler = void (Cpu::*)(uint32_t);
 
   friend class InstructionsTest;
+  friend class RecompiledCode;
   friend constexpr Handler operandsHandler(OperandsFormat);
   friend constexpr Handler instructionHandler(InstructionType);
+  template <CpuVariant Variant, size_t... OpCodes>
+  friend constexpr std::array<Handler, sizeof...(OpCodes)> decodedFallbackHandlers(std::index_sequence<OpCodes...>);
+  template <CpuVariant Variant, class Bus, size_t... OpCodes>
+  friend constexpr std::array<Handler, sizeof...(OpCodes)> opCodeHandlers(std::index_sequence<OpCodes...>);
+  template <CpuVariant Variant, size_t... OpCodes>
+  friend constexpr std::array<InstructionHandler, sizeof...(OpCodes)> instructionHandlers(std::index_sequence<OpCodes...>);
+  template <CpuVariant Variant, size_t... OpCodes>
+  friend constexpr std::array<SequenceHandler, sizeof...(OpCodes)> sequenceHandlers(std::index_sequence<OpCodes...>);
+  template <size_t... OpCodes>
+  friend constexpr FusionRule fusionRule();
 
-  Registers regs;
+  using CpuCore::regs;
 
   Cpu(Memory&);
   bool running() const { return state == CpuState::Running; }
+  CpuEngine engine() const { return activeEngine; }
+  void changeEngine(CpuEngine);
+  CpuVariant variant() const { return activeVariant; }
+  void changeVariant(CpuVariant);
+  void observeBus(BusObserver observer) { busObserver = std::move(observer); }
+  bool highLevelEmulation() const { return highLevelEmulationEnabled; }
+  void changeHighLevelEmulation(bool enabled) { highLevelEmulationEnabled = enabled; }
+  std::vector<NativeRoutineUse> replacedRoutines() const;
+  HostServices& hostServices() { return hostServiceTable; }
+  ProcessorPort& processorPort() { return port; }
+  void invalidateCode(AddressRange);
   void reset();
   void resetExecutionState();
   void resetStatistics();
   void stopExecution();
   void execute(bool continuous, Duration period = Duration(1000));
+  void executeUntil(long cycle, Duration period = Duration(1000));
+  EventId scheduleEvent(long cycle, EventHandler handler);
+  bool cancelEvent(EventId id) { return eventScheduler.cancel(id); }
+  long hangDetection() const { return hangCheckInterval; }
+  void changeHangDetection(long interval);
+  const std::optional<HangReport>& hangReport() const { return lastHangReport; }
+  Snapshot takeSnapshot();
+  void restoreSnapshot(const Snapshot&);
+  long rewindInterval() const { return rewindHistory.interval(); }
+  void changeRewindInterval(long cycles) { rewindHistory.changeInterval(cycles); }
+  bool stepBack();
+  bool runBackTo(Address);
+  const InputLog& inputLog() const { return inputRecord; }
+  void recordInputs(uint32_t seed);
+  void replayInputs(InputLog);
+  void stopInputLog();
+  void recordInput(InputKind kind, Address address = 0, uint16_t value = 0, Data bytes = {});
+  const WriteHistory& writeHistory() const { return writeLog; }
+  void changeWriteHistory(size_t capacity) { writeLog.changeCapacity(capacity); }
   void triggerReset();
   void triggerNmi();
   void triggerIrq();
   CpuInfo info() const;
+  Registers registers() const;
 
 private:
-  CpuRunLevel runLevel = CpuRunLevel::Normal;
-  CpuState state = CpuState::Idle;
-  long cycles;
-  Duration duration;
+  CpuEngine activeEngine = CpuEngine::Threaded;
+  CpuVariant activeVariant = CpuVariant::Nmos;
 
   Memory& memory;
-  OperandPtr operandPtr;
-  OperandPtr effectiveOperandPtr;
-  uint16_t effectiveAddress;
-  bool pageBoundaryCrossed;
+  Duration duration = Duration::zero();
+  DecodeCache decodeCache;
+  TranslationCache translationCache;
+  BusObserver busObserver;
+  bool highLevelEmulationEnabled = false;
+  std::map<Address, NativeRoutineUse> nativeRoutineUses;
+  HostServices hostServiceTable;
+  ProcessorPort port;
+  EventScheduler eventScheduler;
+  HangDetector hangDetector;
+  long hangCheckInterval = 0;
+  EventId hangCheckEvent = 0;
+  uint64_t dispatchedAtHangCheck = 0;
+  uint64_t deviceAccessesAtHangCheck = 0;
+  std::optional<HangReport> lastHangReport;
+  Snapshot::PageTable snapshotPages; // pages of the last snapshot taken or restored
+  Memory::Generation snapshotGeneration = 0;
+  RewindHistory rewindHistory;
+  InputLog inputRecord;
+  WriteHistory writeLog;
+  Address instructionAddress = 0; // of the instruction doing the writes logged
+  bool replaying = false;
+  std::mutex idleMutex;
+  std::condition_variable idleWakeUp;
 
+  void busCycle(uint16_t address, uint8_t value, BusAccess access) {
+    if (busObserver) busObserver(cycles, address, value, access);
+    if (access == BusAccess::Write && writeLog.enabled()) writeLog.add(cycles, instructionAddress, address, memory[address], value);
+    cycles++;
+  }
+
+  template <class Bus = FastBus>
+  uint8_t read(uint16_t address) {
+    const uint8_t value = memory.read(address);
+    if constexpr (Bus::CycleExact) busCycle(address, value, BusAccess::Read);
+    return value;
+  }
+
+  template <class Bus = FastBus>
+  void dummyRead(uint16_t address) {
+    if constexpr (Bus::CycleExact) busCycle(address, memory.read(address), BusAccess::Read);
+  }
+
+  // cycle the fast bus only counts, the exact one spends it on a dummy read
+  template <class Bus = FastBus>
+  void extraCycle(uint16_t address) {
+    if constexpr (Bus::CycleExact) {
+      dummyRead<Bus>(address);
+    } else {
+      cycles++;
+    }
+  }
+
+  template <class Bus = FastBus>
+  void write(uint16_t address, uint8_t value) {
+    if constexpr (Bus::CycleExact) busCycle(address, value, BusAccess::Write);
+    if constexpr (Bus::LogsWrites) writeLog.add(cycles, instructionAddress, address, memory[address], value);
+    memory.write(address, value);
+    if (decodeCache.covers(address)) decodeCache.invalidate(address);
+    if (translationCache.covers(address)) translationCache.invalidate(address);
+  }
+
+  template <class Bus = FastBus>
+  uint16_t readWord(uint16_t address) {
+    const uint8_t lo = read<Bus>(address);
+    return static_cast<uint16_t>(lo | read<Bus>(static_cast<uint16_t>(address + 1)) << 8);
+  }
+
+  template <class Bus = FastBus>
   void push(uint8_t b) {
-    memory[regs.sp.address()] = b;
+    write<Bus>(regs.sp.address(), b);
     regs.sp.offset--;
   }
 
+  template <class Bus = FastBus>
   uint8_t pull() {
     regs.sp.offset++;
-    return memory[regs.sp.address()];
+    return read<Bus>(regs.sp.address());
   }
 
+  template <class Bus = FastBus>
   void pushWord(uint16_t word) {
-    push(word >> 8);
-    push(static_cast<uint8_t>(word));
+    push<Bus>(word >> 8);
+    push<Bus>(static_cast<uint8_t>(word));
   }
 
-  uint16_t pullWord() { return uint16_t(pull() | pull() << 8); }
+  template <class Bus = FastBus>
+  uint16_t pullWord() {
+    const uint8_t lo = pull<Bus>();
+    return static_cast<uint16_t>(lo | pull<Bus>() << 8);
+  }
 
   void calculateZeroPageEffectiveAddress(uint8_t address, uint8_t offset) {
     const uint8_t result = address + offset;
@@ -73,7 +204,10 @@ private:
     pageBoundaryCrossed = (address ^ effectiveAddress) & 0xff00;
   }
 
-  void setEffectiveOperandPtrToAddress() { effectiveOperandPtr.lo = &memory[effectiveAddress]; }
+  void setEffectiveOperandPtrToAddress() {
+    effectiveOperandPtr.lo = &memory[effectiveAddress];
+    deviceOperand = memory.device(effectiveAddress);
+  }
 
   void execBranch() {
     cycles++;
@@ -82,7 +216,142 @@ private:
     if (pageBoundaryCrossed) cycles++;
   }
 
-  void execCompare(uint8_t op1) { regs.p.computeNZC(op1 + (*effectiveOperandPtr.lo ^ 0xff) + uint8_t(1)); }
+  template <class Bus = FastBus>
+  uint16_t zeroPageWord(uint8_t address) {
+    const uint8_t lo = read<Bus>(address);
+    return static_cast<uint16_t>(lo | read<Bus>(static_cast<uint8_t>(address + 1)) << 8);
+  }
+
+  // index added to a 16-bit base, the exact bus reads the not yet carried address first as the hardware does
+  template <class Bus = FastBus>
+  uint16_t indexedAddress(uint16_t base, uint8_t index) {
+    const uint16_t address = static_cast<uint16_t>(base + index);
+    dummyRead<Bus>(static_cast<uint16_t>((base & 0xff00) | (address & 0x00ff)));
+    return address;
+  }
+
+  void addWithCarry(uint8_t op2) {
+    const uint16_t result = AddWithCarryTable[regs.p.decimal][regs.a + op2 + regs.p.carry];
+    regs.p.carry = result & AluCarryBit;
+    regs.p.deferNZ(result);
+    regs.p.computeV(regs.a, op2, result);
+    regs.a = static_cast<uint8_t>(result);
+  }
+
+  void subtractWithBorrow(uint8_t op2) {
+    op2 ^= 0xff;
+    const uint16_t result = SubtractWithBorrowTable[regs.p.decimal][regs.a + op2 + regs.p.carry];
+    regs.p.carry = result & AluCarryBit;
+    regs.p.deferNZ(result);
+    regs.p.computeV(regs.a, op2, result);
+    regs.a = static_cast<uint8_t>(result);
+  }
+
+  void compare(uint8_t op1, uint8_t op2) { regs.p.deferNZC(op1 + (op2 ^ 0xff) + uint8_t(1)); }
+
+  void bitTest(uint8_t operand) {
+    regs.p.deferZ(regs.a & operand);
+    regs.p.deferN(operand);
+    regs.p.overflow = operand & 0x40;
+  }
+
+  uint8_t shiftLeft(uint8_t val) {
+    regs.p.carry = val & 0x80;
+    val <<= 1;
+    regs.p.deferNZ(val);
+    return val;
+  }
+
+  uint8_t shiftRight(uint8_t val) {
+    regs.p.carry = val & 0x01;
+    val >>= 1;
+    regs.p.deferNZ(val);
+    return val;
+  }
+
+  uint8_t rotateLeft(uint8_t val) {
+    const uint16_t res = static_cast<uint16_t>(val << 1) | regs.p.carry;
+    regs.p.carry = res & 0x100;
+    regs.p.deferNZ(res);
+    return static_cast<uint8_t>(res);
+  }
+
+  uint8_t rotateRight(uint8_t val) {
+    const uint16_t tmp = val | (regs.p.carry ? 0x100 : 0x00);
+    regs.p.carry = tmp & 0x01;
+    regs.p.deferNZ(tmp >> 1);
+    return static_cast<uint8_t>(tmp >> 1);
+  }
+
+  template <class Bus = FastBus>
+  void branch(int8_t displacement) {
+    extraCycle<Bus>(regs.pc);
+    const uint16_t target = static_cast<uint16_t>(regs.pc + displacement);
+    if ((regs.pc ^ target) & 0xff00) extraCycle<Bus>(static_cast<uint16_t>((regs.pc & 0xff00) | (target & 0x00ff)));
+    regs.pc = target;
+  }
+
+  // continuous runs look for idle loops once per interval, the loops have at most this many instructions
+  static constexpr long IdleCheckInterval = 0x4000;
+  static constexpr int MaxIdleLoopLength = 16;
+
+  template <CpuVariant Variant, Handler Step, bool SkipIdleLoops = true>
+  void run(bool continuous, Duration period, long limit);
+  template <CpuVariant Variant>
+  long probeIdleLoop(long limit);
+  Duration waitInIdleLoop(long loopCycles, Duration period, long limit);
+  void wakeUp();
+  void halt() {
+    state = CpuState::Halted;
+    eventHorizon = 0;
+  }
+  template <CpuVariant Variant>
+  void runVariant(bool continuous, Duration period, long limit);
+  void executeWithLimit(bool continuous, Duration period, long limit);
+  void checkHang();
+  AddressRange traceLoop(long period);
+  Snapshot takeSnapshot(const Registers&);
+  void restoreState(const Snapshot&);
+  void restoreCheckpoint(const Snapshot&);
+  void rewindTo(const Snapshot& checkpoint, long cycle);
+  template <class Visit>
+  void replay(long until, Visit);
+  template <CpuVariant Variant, class Visit>
+  void replayVariant(long until, Visit);
+  template <CpuVariant Variant>
+  void stepDecoded();
+  template <CpuVariant Variant, class Bus = FastBus>
+  void stepThreaded();
+  template <CpuVariant Variant>
+  void stepPredecoded();
+  template <CpuVariant Variant>
+  void stepTranslated();
+  const DecodedInstruction& predecode(Address, const Instruction* instructions, const SequenceHandler* handlers);
+  std::unique_ptr<TranslatedBlock> translateBlock(Address first, const Instruction* instructions,
+                                                  const InstructionHandler* handlers) const;
+  bool runNativeRoutine(const NativeRoutine&);
+  void hostCall(uint8_t service);
+  void handleRunLevel();
+  void pushInterruptState();
+  void applyInput(const Input&);
+  void applyDueInputs() {
+    while (cycles >= inputRecord.nextCycle()) applyInput(inputRecord.next());
+  }
+
+  template <CpuVariant Variant, size_t OpCode, class Bus>
+  void execOpCode();
+  template <CpuVariant Variant, size_t OpCode>
+  void execDecodedFallback();
+  template <CpuVariant Variant, size_t OpCode>
+  void execSequenceStep(uint32_t& operands);
+  template <CpuVariant Variant, size_t... OpCodes>
+  void execSequence(uint32_t operands);
+  template <OperandsFormat Mode, class Bus = FastBus>
+  uint16_t effectiveAddressOf(uint16_t operand);
+  template <OperandsFormat Mode, class Bus = FastBus>
+  uint8_t loadOperand(uint16_t operand);
+  template <InstructionType Type, OperandsFormat Mode, class Bus = FastBus>
+  void execInstruction(uint16_t operand);
 
   void nmi();
   void irq();
@@ -0,0 +1,29 @@
+#pragma once
+
+#include "commondefs.h"
+#include "cpustate.h"
+#include "operandptr.h"
+#include "registers.h"
+#include "runlevel.h"
+#include <cstddef>
+
+static constexpr size_t CacheLineSize = 64;
+
+// Interpreter state touched while instructions are executed. It is kept in a single aligned cache line, members are
+// ordered by size so that no padding is needed between them.
+struct alignas(CacheLineSize) CpuCore {
+  OperandPtr operandPtr;
+  OperandPtr effectiveOperandPtr;
+  long cycles = 0;
+  long eventHorizon = 0; // engines step freely until this cycle, then the run loop deals with events and requests
+  Registers regs;
+  uint16_t effectiveAddress;
+  CpuRunLevel runLevel = CpuRunLevel::Normal;
+  CpuState state = CpuState::Idle;
+  bool pageBoundaryCrossed;
+  bool deviceOperand; // the decoded engine leaves instructions touching device pages to the threaded one
+};
+
+static_assert(sizeof(Registers) == 10, "registers are expected to be packed");
+static_assert(sizeof(CpuCore) == CacheLineSize, "hot CPU state must fit in a single cache line");
+static_assert(alignof(CpuCore) == CacheLineSize, "hot CPU state must start at a cache line boundary");
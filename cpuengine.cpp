@@ -0,0 +1,12 @@
+#include "cpuengine.h"
+
+const char* formatCpuEngine(CpuEngine engine) {
+  switch (engine) {
+  case CpuEngine::Decoded: return "decoded";
+  case CpuEngine::Threaded: return "threaded";
+  case CpuEngine::Predecoded: return "predecoded";
+  case CpuEngine::Translated: return "translated";
+  case CpuEngine::CycleExact: return "cycle-exact";
+  }
+  return nullptr;
+}
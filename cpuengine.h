@@ -0,0 +1,7 @@
+#pragma once
+
+#include <cstdint>
+
+enum class CpuEngine : uint8_t { Decoded, Threaded, Predecoded, Translated, CycleExact };
+
+const char* formatCpuEngine(CpuEngine);
@@ -0,0 +1,10 @@
+#include "cpuvariant.h"
+
+const char* formatCpuVariant(CpuVariant variant) {
+  switch (variant) {
+  case CpuVariant::Nmos: return "nmos";
+  case CpuVariant::NmosUndocumented: return "nmos-undocumented";
+  case CpuVariant::Cmos65C02: return "65c02";
+  }
+  return nullptr;
+}
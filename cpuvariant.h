@@ -0,0 +1,7 @@
+#pragma once
+
+#include <cstdint>
+
+enum class CpuVariant : uint8_t { Nmos, NmosUndocumented, Cmos65C02 };
+
+const char* formatCpuVariant(CpuVariant);
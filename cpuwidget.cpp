@@ -29,6 +29,9 @@ CpuWidget::CpuWidget(QWidget* parent, const Memory& memory) : QDockWidget(parent
   connect(ui->skipInstruction, &QAbstractButton::clicked, this, &CpuWidget::skipInstruction);
   connect(ui->continuousExecution, &QAbstractButton::clicked, [&] { emitExecutionRequest(true); });
   connect(ui->stepExecution, &QAbstractButton::clicked, this, [&] { emitExecutionRequest(false); });
+  connect(ui->stepBack, &QAbstractButton::clicked, this, &CpuWidget::stepBackRequested);
+  connect(ui->runBack, &QAbstractButton::clicked, this,
+          [&] { emit runBackRequested(static_cast<uint16_t>(ui->breakpoint->value())); });
   connect(ui->stopExecution, &QAbstractButton::clicked, this, &CpuWidget::stopExecutionRequested);
 
   setMonospaceFont(disassemblerView);
@@ -97,6 +100,9 @@ void CpuWidget::updateUI(CpuState state) {
   ui->continuousExecution->setDisabled(processing);
   ui->stopExecution->setDisabled(!processing);
   ui->stepExecution->setDisabled(processing || state == CpuState::Halted);
+  ui->stepBack->setDisabled(processing);
+  ui->runBack->setDisabled(processing);
+  ui->clearStatistics->setDisabled(processing);
   ui->nmiVector->setDisabled(processing);
   ui->resetVector->setDisabled(processing);
   ui->irqVector->setDisabled(processing);
@@ -19,6 +19,8 @@ public:
 
 signals:
   void executionRequested(bool continuous, Frequency clock);
+  void stepBackRequested();
+  void runBackRequested(uint16_t breakpoint);
   void stopExecutionRequested();
   void clearStatisticsRequested();
   void resetRequested();
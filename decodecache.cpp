@@ -0,0 +1,28 @@
+#include "decodecache.h"
+#include "memory.h"
+#include <algorithm>
+
+DecodeCache::DecodeCache() : entries(Memory::Size) {
+}
+
+void DecodeCache::insert(Address addr, const DecodedInstruction& entry) {
+  entries[addr] = entry;
+  decodedPages[addr >> 8] = true;
+  decodedPages[static_cast<Address>(addr + entry.size - 1) >> 8] = true;
+}
+
+void DecodeCache::invalidate(Address addr) {
+  // written byte can be a part of any sequence starting before it
+  for (int i = 0; i < MaxSequenceSize; i++) entries[static_cast<Address>(addr - i)].handler = nullptr;
+}
+
+void DecodeCache::invalidate(AddressRange range) {
+  if (!range.valid()) return;
+  for (int addr = range.first - MaxSequenceSize + 1; addr <= range.last; addr++)
+    entries[static_cast<Address>(addr)].handler = nullptr;
+}
+
+void DecodeCache::clear() {
+  std::fill(entries.begin(), entries.end(), DecodedInstruction());
+  decodedPages.fill(false);
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include "addressrange.h"
+#include "commondefs.h"
+#include <array>
+#include <vector>
+
+class Cpu;
+
+// Single instruction or fused sequence of instructions, operand bytes of all of them are packed little endian.
+struct DecodedInstruction {
+  void (Cpu::*handler)(uint32_t) = nullptr;
+  uint32_t operands = 0;
+  uint8_t size = 0;
+  uint8_t cycles = 0;
+};
+
+struct FusionRule {
+  std::array<uint8_t, 3> opCodes;
+  uint8_t length;
+  void (Cpu::*handler)(uint32_t);
+};
+
+class DecodeCache {
+public:
+  static constexpr int MaxSequenceSize = 6;
+
+  DecodeCache();
+
+  DecodedInstruction& operator[](Address addr) { return entries[addr]; }
+  bool covers(Address addr) const { return decodedPages[addr >> 8]; }
+  void insert(Address addr, const DecodedInstruction&);
+  void invalidate(Address addr);
+  void invalidate(AddressRange);
+  void clear();
+
+private:
+  std::vector<DecodedInstruction> entries;
+  std::array<bool, 0x100> decodedPages{};
+};
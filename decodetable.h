@@ -1,12 +1,14 @@
 #pragma once
 
 #include "cpu.h"
+#include "fusedhandlers.h"
 #include "instructiontable.h"
 
 struct DecodeEntry {
   const Instruction* instruction = nullptr;
   Cpu::Handler prepareOperands = nullptr;
   Cpu::Handler executeInstruction = nullptr;
+  bool writesOperand = false; // legacy handler writes through the effective operand pointer
 };
 
 constexpr Cpu::Handler operandsHandler(OperandsFormat mode) {
@@ -23,6 +25,8 @@ constexpr Cpu::Handler operandsHandler(OperandsFormat mode) {
   case Absolute: return &Cpu::prepAbsoluteMode;
   case AbsoluteX: return &Cpu::prepAbsoluteXMode;
   case AbsoluteY: return &Cpu::prepAbsoluteYMode;
+
+  default: return nullptr;
   }
 }
 
@@ -98,13 +102,140 @@ constexpr Cpu::Handler instructionHandler(InstructionType instruction) {
   }
 }
 
+// Opcodes added by a variant have no legacy handlers, the decoded engine runs them with the fused handler.
+// Operands are taken from the pointers set up by stepDecoded, which has already moved past the instruction.
+
+template <CpuVariant Variant, size_t OpCode>
+void Cpu::execDecodedFallback() {
+  constexpr Instruction ins = instructionTable(Variant)[OpCode];
+  regs.pc -= ins.size;
+  execInstruction<ins.type, ins.mode>(ins.size == 3 ? operandPtr.word() : *operandPtr.lo);
+}
+
+template <CpuVariant Variant, size_t... OpCodes>
+constexpr std::array<Cpu::Handler, sizeof...(OpCodes)> decodedFallbackHandlers(std::index_sequence<OpCodes...>) {
+  return {{&Cpu::execDecodedFallback<Variant, OpCodes>...}};
+}
+
+constexpr bool hasLegacyHandlers(const Instruction& ins, size_t opCode) {
+  return ins.type != HCL && ins.type == InstructionTable[opCode].type && ins.mode == InstructionTable[opCode].mode;
+}
+
 using DecodeTableType = std::array<DecodeEntry, Instruction::NumberOfOpCodes>;
 
+template <CpuVariant Variant>
 constexpr DecodeTableType DecodeTable = [] {
+  constexpr auto fallbackHandlers =
+      decodedFallbackHandlers<Variant>(std::make_index_sequence<Instruction::NumberOfOpCodes>());
   DecodeTableType dtab;
-  for (size_t i = 0; i < InstructionTable.size(); i++) {
-    const Instruction* ins = &InstructionTable[i];
-    dtab[i] = {ins, operandsHandler(ins->mode), instructionHandler(ins->type)};
+  for (size_t i = 0; i < instructionTable(Variant).size(); i++) {
+    const Instruction* ins = &instructionTable(Variant)[i];
+    if (hasLegacyHandlers(*ins, i))
+      dtab[i] = {ins, operandsHandler(ins->mode), instructionHandler(ins->type), writesOperand(*ins)};
+    else
+      dtab[i] = {ins, &Cpu::prepImpliedOrAccumulatorMode, fallbackHandlers[i]};
   }
   return dtab;
 }();
+
+template <CpuVariant Variant, size_t OpCode, class Bus>
+void Cpu::execOpCode() {
+  constexpr Instruction ins = instructionTable(Variant)[OpCode];
+  uint16_t operand = 0;
+  if constexpr (Bus::CycleExact) {
+    // opcode fetch, then the operand bytes, one byte instructions read the next one anyway;
+    // JSR fetches its high byte only after pushing the return address
+    const long first = cycles;
+    if constexpr (ins.type != KIL) read<Bus>(regs.pc);
+    if constexpr (ins.type != KIL && ins.cycles > 1) operand = read<Bus>(static_cast<Address>(regs.pc + 1));
+    if constexpr (ins.size == 3 && ins.type != JSR)
+      operand = static_cast<uint16_t>(operand | read<Bus>(static_cast<Address>(regs.pc + 2)) << 8);
+    execInstruction<ins.type, ins.mode, Bus>(operand);
+    // bus activity of the long NOPs and STP isn't modelled, they take table time
+    if constexpr (ins.type == NOP || ins.type == KIL)
+      while (cycles - first < ins.cycles) dummyRead<Bus>(regs.pc);
+  } else {
+    if constexpr (ins.size == 2) operand = memory[static_cast<Address>(regs.pc + 1)];
+    if constexpr (ins.size == 3) operand = memory.word(static_cast<Address>(regs.pc + 1));
+    execInstruction<ins.type, ins.mode, Bus>(operand);
+    cycles += ins.cycles;
+  }
+}
+
+template <CpuVariant Variant, class Bus, size_t... OpCodes>
+constexpr std::array<Cpu::Handler, sizeof...(OpCodes)> opCodeHandlers(std::index_sequence<OpCodes...>) {
+  return {{&Cpu::execOpCode<Variant, OpCodes, Bus>...}};
+}
+
+using OpCodeTableType = std::array<Cpu::Handler, Instruction::NumberOfOpCodes>;
+
+template <CpuVariant Variant, class Bus = FastBus>
+constexpr OpCodeTableType OpCodeTable =
+    opCodeHandlers<Variant, Bus>(std::make_index_sequence<Instruction::NumberOfOpCodes>());
+
+template <CpuVariant Variant, size_t... OpCodes>
+constexpr std::array<Cpu::InstructionHandler, sizeof...(OpCodes)> instructionHandlers(std::index_sequence<OpCodes...>) {
+  return {{&Cpu::execInstruction<instructionTable(Variant)[OpCodes].type, instructionTable(Variant)[OpCodes].mode>...}};
+}
+
+using InstructionHandlerTableType = std::array<Cpu::InstructionHandler, Instruction::NumberOfOpCodes>;
+
+template <CpuVariant Variant>
+constexpr InstructionHandlerTableType InstructionHandlerTable =
+    instructionHandlers<Variant>(std::make_index_sequence<Instruction::NumberOfOpCodes>());
+
+template <CpuVariant Variant, size_t OpCode>
+void Cpu::execSequenceStep(uint32_t& operands) {
+  constexpr Instruction ins = instructionTable(Variant)[OpCode];
+  constexpr auto bits = 8 * (ins.size - 1);
+  execInstruction<ins.type, ins.mode>(static_cast<uint16_t>(operands & ((1U << bits) - 1)));
+  operands >>= bits;
+}
+
+template <CpuVariant Variant, size_t... OpCodes>
+void Cpu::execSequence(uint32_t operands) {
+  (execSequenceStep<Variant, OpCodes>(operands), ...);
+}
+
+template <CpuVariant Variant, size_t... OpCodes>
+constexpr std::array<Cpu::SequenceHandler, sizeof...(OpCodes)> sequenceHandlers(std::index_sequence<OpCodes...>) {
+  return {{&Cpu::execSequence<Variant, OpCodes>...}};
+}
+
+using SequenceHandlerTableType = std::array<Cpu::SequenceHandler, Instruction::NumberOfOpCodes>;
+
+template <CpuVariant Variant>
+constexpr SequenceHandlerTableType SequenceHandlerTable =
+    sequenceHandlers<Variant>(std::make_index_sequence<Instruction::NumberOfOpCodes>());
+
+constexpr bool sameInAllVariants(size_t opCode) {
+  for (const auto variant : {CpuVariant::NmosUndocumented, CpuVariant::Cmos65C02}) {
+    const auto& ins = instructionTable(variant)[opCode];
+    if (ins.type != InstructionTable[opCode].type || ins.mode != InstructionTable[opCode].mode ||
+        ins.cycles != InstructionTable[opCode].cycles)
+      return false;
+  }
+  return true;
+}
+
+template <size_t... OpCodes>
+constexpr FusionRule fusionRule() {
+  static_assert((InstructionTable[OpCodes].size + ...) <= DecodeCache::MaxSequenceSize);
+  static_assert((sameInAllVariants(OpCodes) && ...), "fused opcodes are shared by all variants");
+  return {{static_cast<uint8_t>(OpCodes)...}, sizeof...(OpCodes), &Cpu::execSequence<CpuVariant::Nmos, OpCodes...>};
+}
+
+// Frequent idioms of counting and copying loops, run as one handler. Longer sequences go first.
+constexpr FusionRule FusionRules[]{
+    fusionRule<0xe8, 0xe0, 0xd0>(), // INX, CPX #, BNE
+    fusionRule<0xc8, 0xc0, 0xd0>(), // INY, CPY #, BNE
+    fusionRule<0xca, 0xd0>(),       // DEX, BNE
+    fusionRule<0x88, 0xd0>(),       // DEY, BNE
+    fusionRule<0xc9, 0xf0>(),       // CMP #, BEQ
+    fusionRule<0xc9, 0xd0>(),       // CMP #, BNE
+    fusionRule<0xbd, 0x9d>(),       // LDA abs,X, STA abs,X
+    fusionRule<0xb9, 0x99>(),       // LDA abs,Y, STA abs,Y
+    fusionRule<0x18, 0x69>(),       // CLC, ADC #
+    fusionRule<0x18, 0x65>(),       // CLC, ADC zp
+    fusionRule<0x18, 0x6d>(),       // CLC, ADC abs
+};
@@ -15,14 +15,14 @@ QString Disassembler::formatOperand16() const {
   return "$" + formatHexWord(memory.word(address + 1));
 }
 
-Disassembler::Disassembler(const Memory& memory, Address pc) : memory(memory) {
+Disassembler::Disassembler(const Memory& memory, Address pc, CpuVariant variant) : memory(memory), variant(variant) {
   setOrigin(pc);
 }
 
 void Disassembler::setOrigin(Address addr) {
   address = addr;
   opcode = memory[addr];
-  instruction = InstructionTable[opcode];
+  instruction = instructionTable(variant)[opcode];
 }
 
 void Disassembler::nextInstruction() {
@@ -58,7 +58,9 @@ QString Disassembler::disassemble() const {
   case ZeroPageY: str.append(formatOperand8()).append(",Y"); break;
   case IndexedIndirectX: str.append("(").append(formatOperand8()).append(",X)"); break;
   case IndirectIndexedY: str.append("(").append(formatOperand8()).append("),Y"); break;
+  case ZeroPageIndirect: str.append("(").append(formatOperand8()).append(")"); break;
   case Indirect: str.append("(").append(formatOperand16()).append(")"); break;
+  case AbsoluteIndexedIndirect: str.append("(").append(formatOperand16()).append(",X)"); break;
   case Branch:
     const auto displacement = static_cast<int8_t>(memory[address + 1]);
     if (displacement > 0) str.append("+");
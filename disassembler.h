@@ -1,12 +1,13 @@
 #pragma once
 
+#include "cpuvariant.h"
 #include "instruction.h"
 #include "memory.h"
 #include <QString>
 
 class Disassembler {
 public:
-  Disassembler(const Memory&, Address addr = 0);
+  Disassembler(const Memory&, Address addr = 0, CpuVariant variant = CpuVariant::Nmos);
 
   void setOrigin(Address);
   Address currentAddress() const { return address; }
@@ -18,6 +19,7 @@ public:
 
 private:
   const Memory& memory;
+  const CpuVariant variant;
   Address address;
   uint8_t opcode;
   Instruction instruction;
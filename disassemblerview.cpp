@@ -27,7 +27,7 @@ uint16_t DisassemblerView::first() const {
 }
 
 void DisassemblerView::updateMemoryView(AddressRange range) {
-  if (range.overlapsWith(range)) updateView();
+  if (!addressRange.valid() || addressRange.overlapsWith(range)) updateView();
 }
 
 void DisassemblerView::changeStart(Address addr) {
@@ -1,17 +1,24 @@
 #include "emulator.h"
+#include "commonformatters.h"
 #include <QFile>
 #include <QThread>
 #include <algorithm>
+#include <limits>
+#include <random>
+#include <sstream>
+
+static constexpr long RewindInterval = 100000;
 
 Emulator::Emulator(QObject* parent) : QObject(parent), cpu(memory) {
-  std::generate(memory.begin(), memory.end(), [] { return std::rand(); });
+  fillMemory(MemorySeed);
+  cpu.changeRewindInterval(RewindInterval);
   clearStatistics();
 }
 
 void Emulator::loadMemory(Address start, const Data& data) {
   auto size = static_cast<uint16_t>(std::min(static_cast<size_t>(data.size()), memory.size() - start));
   std::copy_n(data.begin(), size, memory.begin() + start);
-  emit memoryContentChanged({start, static_cast<Address>(start + size - 1)});
+  updateOnChange({start, static_cast<Address>(start + size - 1)});
 }
 
 void Emulator::loadMemoryFromFile(uint16_t start, const QString& fname) {
@@ -31,13 +38,14 @@ void Emulator::saveMemoryToFile(AddressRange range, const QString& fname) {
   qint64 rsize = -1;
   if (file.open(QIODevice::WriteOnly | QIODevice::Text)) {
     Data buf(range.size());
-    std::copy_n(&memory[range.first], range.size(), buf.begin());
+    std::copy_n(memory.cbegin() + range.first, range.size(), buf.begin());
     rsize = file.write(reinterpret_cast<char*>(buf.data()), static_cast<int>(buf.size()));
   }
   emit operationCompleted(rsize > 0 ? tr("saved %1 B\nto file %2").arg(rsize).arg(fname) : "save error", rsize > 0);
 }
 
 void Emulator::clearStatistics() {
+  if (cpu.running() || refusedByInputLog()) return;
   cpu.resetStatistics();
   cpu.resetExecutionState();
   if (auto st = state(); !st.running()) emit stateChanged(state());
@@ -45,20 +53,23 @@ void Emulator::clearStatistics() {
 
 const EmulatorState Emulator::state(ExecutionStatistics lastRun) {
   const auto info = cpu.info();
-  return {info.state, info.runLevel, cpu.regs, info.executionStatistics, lastRun};
+  return {info.state, info.runLevel, cpu.registers(), info.executionStatistics, lastRun, cpu.inputLog().mode()};
 }
 
 void Emulator::triggerIrq() {
+  if (cpu.inputLog().replaying()) return;
   cpu.triggerIrq();
   emit stateChanged(state());
 }
 
 void Emulator::triggerNmi() {
+  if (cpu.inputLog().replaying()) return;
   cpu.triggerNmi();
   emit stateChanged(state());
 }
 
 void Emulator::triggerReset() {
+  if (cpu.inputLog().replaying()) return;
   cpu.triggerReset();
   emit stateChanged(state());
 }
@@ -71,16 +82,18 @@ void Emulator::stopExecution() {
 
 void Emulator::execute(bool continuous, Frequency clock) {
   QSignalBlocker sb(this);
+  const auto since = memory.startGeneration();
   const auto exs0 = cpu.info().executionStatistics;
   cpu.execute(continuous, std::chrono::duration_cast<Duration>(std::chrono::duration<double>(1.0 / clock)));
   const auto exs1 = cpu.info().executionStatistics;
   sb.unblock();
   emit stateChanged(state(exs1 - exs0));
-  emit memoryContentChanged(AddressRange::Max);
+  for (const auto range : memory.changedRanges(since)) emit memoryContentChanged(range);
 }
 
 void Emulator::changeProgramCounter(Address pc) {
   if (!cpu.running() && cpu.regs.pc != pc) {
+    cpu.recordInput(InputKind::ProgramCounter, 0, pc);
     cpu.regs.pc = pc;
     cpu.resetExecutionState();
     emit stateChanged(state());
@@ -90,6 +103,7 @@ void Emulator::changeProgramCounter(Address pc) {
 void Emulator::changeStackPointer(Address sp) {
   const auto offset = static_cast<uint8_t>(sp);
   if (cpu.regs.sp.offset != offset) {
+    cpu.recordInput(InputKind::StackPointer, 0, offset);
     cpu.regs.sp.offset = offset;
     emit stateChanged(state());
   }
@@ -97,6 +111,7 @@ void Emulator::changeStackPointer(Address sp) {
 
 void Emulator::changeAccumulator(uint8_t a) {
   if (cpu.regs.a != a) {
+    cpu.recordInput(InputKind::Accumulator, 0, a);
     cpu.regs.a = a;
     emit stateChanged(state());
   }
@@ -104,6 +119,7 @@ void Emulator::changeAccumulator(uint8_t a) {
 
 void Emulator::changeRegisterX(uint8_t x) {
   if (cpu.regs.x != x) {
+    cpu.recordInput(InputKind::RegisterX, 0, x);
     cpu.regs.x = x;
     emit stateChanged(state());
   }
@@ -111,6 +127,7 @@ void Emulator::changeRegisterX(uint8_t x) {
 
 void Emulator::changeRegisterY(uint8_t y) {
   if (cpu.regs.y != y) {
+    cpu.recordInput(InputKind::RegisterY, 0, y);
     cpu.regs.y = y;
     emit stateChanged(state());
   }
@@ -118,5 +135,138 @@ void Emulator::changeRegisterY(uint8_t y) {
 
 void Emulator::changeMemory(Address addr, uint8_t b) {
   memory[addr] = b;
-  emit memoryContentChanged(addr);
+  updateOnChange(addr);
+}
+
+void Emulator::restoreSnapshot(const Snapshot& snapshot) {
+  if (cpu.running() || refusedByInputLog()) return;
+  const auto since = memory.startGeneration();
+  cpu.restoreSnapshot(snapshot);
+  emit stateChanged(state());
+  for (const auto range : memory.changedRanges(since)) emit memoryContentChanged(range);
+}
+
+void Emulator::stepBack() {
+  if (cpu.running() || refusedByInputLog()) return;
+  const auto since = memory.startGeneration();
+  if (!cpu.stepBack()) emit operationCompleted(tr("no earlier instruction recorded"), false);
+  emit stateChanged(state());
+  for (const auto range : memory.changedRanges(since)) emit memoryContentChanged(range);
+}
+
+void Emulator::runBackTo(Address addr) {
+  if (cpu.running() || refusedByInputLog()) return;
+  const auto since = memory.startGeneration();
+  if (!cpu.runBackTo(addr)) emit operationCompleted(tr("$%1 not reached earlier").arg(formatHexWord(addr)), false);
+  emit stateChanged(state());
+  for (const auto range : memory.changedRanges(since)) emit memoryContentChanged(range);
+}
+
+void Emulator::updateOnChange(AddressRange range) {
+  if (cpu.inputLog().recording())
+    cpu.recordInput(InputKind::Memory, range.first, 0,
+                    Data(memory.cbegin() + range.first, memory.cbegin() + range.first + range.size()));
+  cpu.invalidateCode(range);
+  emit memoryContentChanged(range);
+}
+
+// capacity in writes, 0 disables the history
+void Emulator::changeWriteHistory(int capacity) {
+  if (!cpu.running()) cpu.changeWriteHistory(static_cast<size_t>(std::max(capacity, 0)));
+}
+
+// only the latest writes are listed, all are counted
+void Emulator::findWrites(AddressRange range) {
+  if (cpu.running()) return;
+  if (!cpu.writeHistory().enabled()) {
+    emit operationCompleted(tr("write history disabled"), false);
+    return;
+  }
+  auto writes = cpu.writeHistory().writesTo(range, 0, std::numeric_limits<long>::max());
+  const auto count = writes.size();
+  if (count > WritesListed) writes.erase(writes.begin(), writes.begin() + static_cast<long>(count - WritesListed));
+  emit writesFound(range, writes);
+  emit operationCompleted(tr("%1 writes to $%2-$%3").arg(count).arg(formatHexWord(range.first)).arg(formatHexWord(range.last)),
+                          true);
+}
+
+void Emulator::markMemory() {
+  if (cpu.running()) return;
+  markedSnapshot = cpu.takeSnapshot();
+  emit operationCompleted(tr("memory marked"), true);
+}
+
+void Emulator::diffMemory() {
+  if (cpu.running()) return;
+  if (!markedSnapshot) {
+    emit operationCompleted(tr("memory not marked"), false);
+    return;
+  }
+  const MemoryDiff diff(*markedSnapshot, memory);
+  emit memoryDiffed(diff);
+  emit operationCompleted(tr("%1 B changed in %2 ranges").arg(diff.count()).arg(diff.ranges().size()), true);
+}
+
+// Restored states and cleared cycle counts aren't inputs, a recording or replay would no longer match the run
+bool Emulator::refusedByInputLog() {
+  if (cpu.inputLog().mode() == InputLog::Mode::Off) return false;
+  emit operationCompleted(tr("not while inputs are recorded or replayed"), false);
+  return true;
+}
+
+// same contents on every platform, unlike std::rand()
+void Emulator::fillMemory(uint32_t seed) {
+  std::mt19937 random(seed);
+  std::generate(memory.begin(), memory.end(), [&] { return static_cast<uint8_t>(random()); });
+}
+
+// Memory filled from the seed and the processor reset, the state recordings start from
+void Emulator::restart(uint32_t seed) {
+  fillMemory(seed);
+  cpu.invalidateCode(AddressRange::Max);
+  cpu.reset();
+  cpu.resetExecutionState();
+}
+
+void Emulator::startRecording(uint32_t seed) {
+  if (cpu.running()) return;
+  restart(seed);
+  cpu.recordInputs(seed);
+  emit stateChanged(state());
+  emit memoryContentChanged(AddressRange::Max);
+}
+
+void Emulator::stopInputLog() {
+  if (cpu.running()) return;
+  cpu.stopInputLog();
+  emit stateChanged(state());
+}
+
+void Emulator::saveRecording(const QString& fname) {
+  std::ostringstream os;
+  cpu.inputLog().save(os);
+  const auto text = os.str();
+  QFile file(fname);
+  const auto saved =
+      file.open(QIODevice::WriteOnly | QIODevice::Text) && file.write(text.data(), static_cast<qint64>(text.size())) >= 0;
+  emit operationCompleted(saved ? tr("saved %1 inputs\nto file %2").arg(cpu.inputLog().inputs().size()).arg(fname)
+                                : "save error",
+                          saved);
+}
+
+void Emulator::replayRecording(const QString& fname) {
+  if (cpu.running()) return;
+  QFile file(fname);
+  InputLog log;
+  std::istringstream is(file.open(QIODevice::ReadOnly | QIODevice::Text) ? file.readAll().toStdString() : "");
+  if (!log.load(is)) {
+    emit operationCompleted(tr("no inputs recorded\nin file %1").arg(fname), false);
+    return;
+  }
+  restart(log.seed());
+  const auto count = log.inputs().size();
+  cpu.replayInputs(std::move(log));
+  emit stateChanged(state());
+  emit memoryContentChanged(AddressRange::Max);
+  emit operationCompleted(tr("replaying %1 inputs\nfrom file %2").arg(count).arg(fname), true);
 }
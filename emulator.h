@@ -5,21 +5,30 @@
 #include "cpu.h"
 #include "emulatorstate.h"
 #include "memory.h"
+#include "memorydiff.h"
 #include <QObject>
+#include <optional>
+#include <vector>
 
 class Emulator : public QObject {
   Q_OBJECT
 
 public:
+  static constexpr uint32_t MemorySeed = 6502;
+  static constexpr size_t WritesListed = 1000;
+
   explicit Emulator(QObject* parent = nullptr);
   const Memory& memoryView() const { return memory; }
   Memory& memoryRef() { return memory; }
   const EmulatorState state(ExecutionStatistics = {});
+  Snapshot snapshot() { return cpu.takeSnapshot(); }
 
 signals:
   void stateChanged(EmulatorState);
   void memoryContentChanged(AddressRange);
   void operationCompleted(const QString& message, bool success);
+  void memoryDiffed(const MemoryDiff&);
+  void writesFound(AddressRange, const std::vector<WriteHistory::Write>&);
 
 public slots:
   void execute(bool continuous, Frequency clock);
@@ -32,6 +41,18 @@ public slots:
   void loadMemory(Address first, const Data& data);
   void loadMemoryFromFile(Address start, const QString& fname);
   void saveMemoryToFile(AddressRange range, const QString& fname);
+  void updateOnChange(AddressRange);
+  void restoreSnapshot(const Snapshot&);
+  void stepBack();
+  void runBackTo(Address);
+  void changeWriteHistory(int capacity);
+  void findWrites(AddressRange);
+  void markMemory();
+  void diffMemory();
+  void startRecording(uint32_t seed = MemorySeed);
+  void stopInputLog();
+  void saveRecording(const QString& fname);
+  void replayRecording(const QString& fname);
 
   // to be connected as direct connections
 
@@ -44,4 +65,9 @@ public slots:
 private:
   Memory memory;
   Cpu cpu;
+  std::optional<Snapshot> markedSnapshot;
+
+  void fillMemory(uint32_t seed);
+  void restart(uint32_t seed);
+  bool refusedByInputLog();
 };
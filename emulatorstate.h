@@ -3,6 +3,7 @@
 #include "commondefs.h"
 #include "cpustate.h"
 #include "executionstatistics.h"
+#include "inputlog.h"
 #include "registers.h"
 #include "runlevel.h"
 #include <QMetaType>
@@ -14,6 +15,7 @@ struct EmulatorState {
   Registers regs;
   ExecutionStatistics avgExecutionStatistics;
   ExecutionStatistics lastExecutionStatistics;
+  InputLog::Mode inputLogMode = InputLog::Mode::Off;
 
   bool running() const { return state == CpuState::Running; }
 };
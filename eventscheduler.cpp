@@ -0,0 +1,40 @@
+#include "eventscheduler.h"
+#include <algorithm>
+
+bool EventScheduler::later(const Event& e1, const Event& e2) {
+  return e1.cycle > e2.cycle || (e1.cycle == e2.cycle && e1.id > e2.id);
+}
+
+EventId EventScheduler::schedule(long cycle, EventHandler handler) {
+  events.push_back({cycle, ++lastId, std::move(handler)});
+  std::push_heap(events.begin(), events.end(), later);
+  return lastId;
+}
+
+bool EventScheduler::cancel(EventId id) {
+  const auto it = std::find_if(events.begin(), events.end(), [id](const auto& event) { return event.id == id; });
+  if (it == events.end()) return false;
+  events.erase(it);
+  std::make_heap(events.begin(), events.end(), later);
+  return true;
+}
+
+// Runs events due at given cycle or earlier, including the ones scheduled by handlers meanwhile
+void EventScheduler::dispatch(long cycle) {
+  while (!events.empty() && events.front().cycle <= cycle) {
+    std::pop_heap(events.begin(), events.end(), later);
+    const auto event = std::move(events.back());
+    events.pop_back();
+    dispatchedEvents++;
+    event.handler(event.cycle);
+  }
+}
+
+// Moves all events given number of cycles back, as when cycle count starts over
+void EventScheduler::shift(long cycles) {
+  for (auto& event : events) event.cycle -= cycles;
+}
+
+void EventScheduler::clear() {
+  events.clear();
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <vector>
+
+using EventId = uint64_t;
+using EventHandler = std::function<void(long cycle)>; // gets the cycle the event was scheduled at
+
+// Events ordered by the absolute cycle they are due at, events due at the same cycle run in the order they were
+// scheduled. Handlers may schedule further events, e.g. periodic ones at the given cycle plus period.
+class EventScheduler {
+public:
+  static constexpr long Never = std::numeric_limits<long>::max();
+
+  bool empty() const { return events.empty(); }
+  size_t size() const { return events.size(); }
+  long nextCycle() const { return events.empty() ? Never : events.front().cycle; }
+  uint64_t dispatched() const { return dispatchedEvents; }
+
+  EventId schedule(long cycle, EventHandler handler);
+  bool cancel(EventId);
+  void dispatch(long cycle);
+  void shift(long cycles);
+  void clear();
+
+private:
+  struct Event {
+    long cycle;
+    EventId id;
+    EventHandler handler;
+  };
+
+  static bool later(const Event&, const Event&);
+
+  // heap with the earliest event at the front
+  std::vector<Event> events;
+  EventId lastId = 0;
+  uint64_t dispatchedEvents = 0;
+};
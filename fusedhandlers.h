@@ -0,0 +1,194 @@
+#pragma once
+
+#include "cpu.h"
+
+// Addressing mode and operation fused into one handler per opcode. The operand stays in a local value and the page
+// crossing penalty is only computed for modes that can cross a page. With the cycle exact bus the handlers also make
+// the dummy accesses of the hardware, the fast bus compiles them away.
+
+template <OperandsFormat Mode, class Bus>
+uint16_t Cpu::effectiveAddressOf(uint16_t operand) {
+  const uint8_t lo = static_cast<uint8_t>(operand);
+
+  if constexpr (Mode == ZeroPageX || Mode == ZeroPageY || Mode == IndexedIndirectX) dummyRead<Bus>(lo);
+  if constexpr (Mode == ZeroPage) return lo;
+  if constexpr (Mode == ZeroPageX) return static_cast<uint8_t>(lo + regs.x);
+  if constexpr (Mode == ZeroPageY) return static_cast<uint8_t>(lo + regs.y);
+  if constexpr (Mode == IndexedIndirectX) return zeroPageWord<Bus>(static_cast<uint8_t>(lo + regs.x));
+  if constexpr (Mode == IndirectIndexedY) return indexedAddress<Bus>(zeroPageWord<Bus>(lo), regs.y);
+  if constexpr (Mode == ZeroPageIndirect) return zeroPageWord<Bus>(lo);
+
+  if constexpr (Mode == Absolute) return operand;
+  if constexpr (Mode == AbsoluteX) return indexedAddress<Bus>(operand, regs.x);
+  if constexpr (Mode == AbsoluteY) return indexedAddress<Bus>(operand, regs.y);
+  if constexpr (Mode == Indirect) return readWord<Bus>(operand);
+  if constexpr (Mode == AbsoluteIndexedIndirect) {
+    dummyRead<Bus>(static_cast<uint16_t>(regs.pc - 1));
+    return readWord<Bus>(static_cast<uint16_t>(operand + regs.x));
+  }
+}
+
+template <OperandsFormat Mode, class Bus>
+uint8_t Cpu::loadOperand(uint16_t operand) {
+  if constexpr (Mode == ImpliedOrAccumulator) {
+    return regs.a;
+  } else if constexpr (Mode == Immediate) {
+    return static_cast<uint8_t>(operand);
+  } else if constexpr (Mode == AbsoluteX || Mode == AbsoluteY || Mode == IndirectIndexedY) {
+    const uint16_t base = Mode == IndirectIndexedY ? zeroPageWord<Bus>(static_cast<uint8_t>(operand)) : operand;
+    const uint16_t address = static_cast<uint16_t>(base + (Mode == AbsoluteX ? regs.x : regs.y));
+    if ((base ^ address) & 0xff00) extraCycle<Bus>(static_cast<uint16_t>((base & 0xff00) | (address & 0x00ff)));
+    return read<Bus>(address);
+  } else {
+    return read<Bus>(effectiveAddressOf<Mode, Bus>(operand));
+  }
+}
+
+template <InstructionType Type, OperandsFormat Mode, class Bus>
+void Cpu::execInstruction(uint16_t operand) {
+  if constexpr (Type == KIL) {
+    halt();
+    return;
+  }
+
+  regs.pc += Instruction::sizeForAddressingMode(Mode);
+
+  if constexpr (Type == LDA) regs.p.deferNZ(regs.a = loadOperand<Mode, Bus>(operand));
+  if constexpr (Type == LDX) regs.p.deferNZ(regs.x = loadOperand<Mode, Bus>(operand));
+  if constexpr (Type == LDY) regs.p.deferNZ(regs.y = loadOperand<Mode, Bus>(operand));
+  if constexpr (Type == STA) write<Bus>(effectiveAddressOf<Mode, Bus>(operand), regs.a);
+  if constexpr (Type == STX) write<Bus>(effectiveAddressOf<Mode, Bus>(operand), regs.x);
+  if constexpr (Type == STY) write<Bus>(effectiveAddressOf<Mode, Bus>(operand), regs.y);
+
+  if constexpr (Type == ADC) addWithCarry(loadOperand<Mode, Bus>(operand));
+  if constexpr (Type == SBC) subtractWithBorrow(loadOperand<Mode, Bus>(operand));
+  if constexpr (Type == AND) regs.p.deferNZ(regs.a &= loadOperand<Mode, Bus>(operand));
+  if constexpr (Type == ORA) regs.p.deferNZ(regs.a |= loadOperand<Mode, Bus>(operand));
+  if constexpr (Type == EOR) regs.p.deferNZ(regs.a ^= loadOperand<Mode, Bus>(operand));
+  if constexpr (Type == CMP) compare(regs.a, loadOperand<Mode, Bus>(operand));
+  if constexpr (Type == CPX) compare(regs.x, loadOperand<Mode, Bus>(operand));
+  if constexpr (Type == CPY) compare(regs.y, loadOperand<Mode, Bus>(operand));
+  if constexpr (Type == HCL) hostCall(static_cast<uint8_t>(operand));
+  if constexpr (Type == BIT && Mode == Immediate) regs.p.deferZ(regs.a & operand);
+  if constexpr (Type == BIT && Mode != Immediate) bitTest(loadOperand<Mode, Bus>(operand));
+
+  if constexpr (Type == ASL || Type == LSR || Type == ROL || Type == ROR || Type == INC || Type == DEC || Type == SLO ||
+                Type == RLA || Type == SRE || Type == RRA || Type == DCP || Type == ISC || Type == TRB || Type == TSB) {
+    uint8_t value = regs.a;
+    uint16_t address = 0;
+    if constexpr (Mode != ImpliedOrAccumulator) {
+      value = read<Bus>(address = effectiveAddressOf<Mode, Bus>(operand));
+      if constexpr (Bus::CycleExact) write<Bus>(address, value);
+    }
+    if constexpr (Type == ASL || Type == SLO) value = shiftLeft(value);
+    if constexpr (Type == LSR || Type == SRE) value = shiftRight(value);
+    if constexpr (Type == ROL || Type == RLA) value = rotateLeft(value);
+    if constexpr (Type == ROR || Type == RRA) value = rotateRight(value);
+    if constexpr (Type == INC) regs.p.deferNZ(++value);
+    if constexpr (Type == DEC) regs.p.deferNZ(--value);
+    if constexpr (Type == DCP) compare(regs.a, --value);
+    if constexpr (Type == ISC) subtractWithBorrow(++value);
+    if constexpr (Type == SLO) regs.p.deferNZ(regs.a |= value);
+    if constexpr (Type == RLA) regs.p.deferNZ(regs.a &= value);
+    if constexpr (Type == SRE) regs.p.deferNZ(regs.a ^= value);
+    if constexpr (Type == RRA) addWithCarry(value);
+    if constexpr (Type == TRB || Type == TSB) regs.p.deferZ(regs.a & value);
+    if constexpr (Type == TRB) value &= ~regs.a;
+    if constexpr (Type == TSB) value |= regs.a;
+    if constexpr (Mode == ImpliedOrAccumulator) regs.a = value;
+    if constexpr (Mode != ImpliedOrAccumulator) write<Bus>(address, value);
+  }
+
+  if constexpr (Type == LAX) regs.p.deferNZ(regs.a = regs.x = loadOperand<Mode, Bus>(operand));
+  if constexpr (Type == SAX) write<Bus>(effectiveAddressOf<Mode, Bus>(operand), regs.a & regs.x);
+  if constexpr (Type == STZ) write<Bus>(effectiveAddressOf<Mode, Bus>(operand), 0);
+  if constexpr (Type == ANC) {
+    regs.p.deferNZ(regs.a &= loadOperand<Mode, Bus>(operand));
+    regs.p.carry = regs.a & 0x80;
+  }
+  if constexpr (Type == ALR) regs.a = shiftRight(regs.a & loadOperand<Mode, Bus>(operand));
+  if constexpr (Type == ARR) {
+    regs.a = rotateRight(regs.a & loadOperand<Mode, Bus>(operand));
+    regs.p.carry = regs.a & 0x40;
+    regs.p.overflow = (regs.a ^ (regs.a << 1)) & 0x40;
+  }
+  if constexpr (Type == SBX) {
+    const uint16_t result = (regs.a & regs.x) + (loadOperand<Mode, Bus>(operand) ^ 0xff) + 1;
+    regs.p.deferNZC(result);
+    regs.x = static_cast<uint8_t>(result);
+  }
+  if constexpr (Type == NOP && Mode != ImpliedOrAccumulator) loadOperand<Mode, Bus>(operand);
+
+  if constexpr (Type == INX) regs.p.deferNZ(++regs.x);
+  if constexpr (Type == INY) regs.p.deferNZ(++regs.y);
+  if constexpr (Type == DEX) regs.p.deferNZ(--regs.x);
+  if constexpr (Type == DEY) regs.p.deferNZ(--regs.y);
+
+  if constexpr (Type == SED) regs.p.decimal = true;
+  if constexpr (Type == SEI) regs.p.interrupt = true;
+  if constexpr (Type == SEC) regs.p.carry = true;
+  if constexpr (Type == CLC) regs.p.carry = false;
+  if constexpr (Type == CLD) regs.p.decimal = false;
+  if constexpr (Type == CLI) regs.p.interrupt = false;
+  if constexpr (Type == CLV) regs.p.overflow = false;
+
+  if constexpr (Type == TAX) regs.p.deferNZ(regs.x = regs.a);
+  if constexpr (Type == TXA) regs.p.deferNZ(regs.a = regs.x);
+  if constexpr (Type == TAY) regs.p.deferNZ(regs.y = regs.a);
+  if constexpr (Type == TYA) regs.p.deferNZ(regs.a = regs.y);
+  if constexpr (Type == TSX) regs.p.deferNZ(regs.x = regs.sp.offset);
+  if constexpr (Type == TXS) regs.sp.offset = regs.x;
+
+  if constexpr (Type == PHA) push<Bus>(regs.a);
+  if constexpr (Type == PHX) push<Bus>(regs.x);
+  if constexpr (Type == PHY) push<Bus>(regs.y);
+  if constexpr (Type == PLA || Type == PLX || Type == PLY || Type == PLP || Type == RTS || Type == RTI)
+    dummyRead<Bus>(regs.sp.address());
+  if constexpr (Type == PLA) regs.p.deferNZ(regs.a = pull<Bus>());
+  if constexpr (Type == PLX) regs.p.deferNZ(regs.x = pull<Bus>());
+  if constexpr (Type == PLY) regs.p.deferNZ(regs.y = pull<Bus>());
+  if constexpr (Type == PHP) {
+    regs.p.resolveNZ();
+    push<Bus>(regs.p);
+  }
+  if constexpr (Type == PLP) regs.p = pull<Bus>();
+
+  if constexpr (Type == BCC || Type == BCS || Type == BEQ || Type == BMI || Type == BNE || Type == BPL || Type == BVC ||
+                Type == BVS || Type == BRA) {
+    bool taken = Type == BRA;
+    if constexpr (Type == BCC) taken = !regs.p.carry;
+    if constexpr (Type == BCS) taken = regs.p.carry;
+    if constexpr (Type == BEQ) taken = regs.p.deferredZero();
+    if constexpr (Type == BMI) taken = regs.p.deferredNegative();
+    if constexpr (Type == BNE) taken = !regs.p.deferredZero();
+    if constexpr (Type == BPL) taken = !regs.p.deferredNegative();
+    if constexpr (Type == BVC) taken = !regs.p.overflow;
+    if constexpr (Type == BVS) taken = regs.p.overflow;
+    if (taken) branch<Bus>(static_cast<int8_t>(operand));
+  }
+
+  if constexpr (Type == JMP) regs.pc = effectiveAddressOf<Mode, Bus>(operand);
+  if constexpr (Type == JSR) {
+    dummyRead<Bus>(regs.sp.address());
+    pushWord<Bus>(regs.pc - 1);
+    // the exact bus fetches the high byte of the target only after pushing the return address
+    if constexpr (Bus::CycleExact) operand = static_cast<uint16_t>(operand | read<Bus>(static_cast<uint16_t>(regs.pc - 1)) << 8);
+    regs.pc = effectiveAddressOf<Mode, Bus>(operand);
+  }
+  if constexpr (Type == RTS) {
+    regs.pc = pullWord<Bus>();
+    dummyRead<Bus>(regs.pc++);
+  }
+  if constexpr (Type == RTI) {
+    regs.p = pull<Bus>();
+    regs.pc = pullWord<Bus>();
+    regs.p.interrupt = false;
+  }
+  if constexpr (Type == BRK) {
+    pushWord<Bus>(regs.pc + 1);
+    regs.p.resolveNZ();
+    push<Bus>(regs.p | ProcessorStatus::BreakBitMask);
+    regs.p.interrupt = true;
+    regs.pc = readWord<Bus>(CpuAddress::IrqVector);
+  }
+}
@@ -0,0 +1,59 @@
+#include "hangdetector.h"
+#include <cstdio>
+#include <cstring>
+
+std::string formatHangReport(const HangReport& report) {
+  char buf[128];
+  if (report.cause == HangCause::Halted)
+    std::snprintf(buf, sizeof buf, "halted at $%04X, cycle %ld", report.loop.first, report.cycle);
+  else
+    std::snprintf(buf, sizeof buf, "endless loop at $%04X-$%04X, same state again after %ld cycles, detected at cycle %ld",
+                  report.loop.first, report.loop.last, report.period, report.cycle);
+  return buf;
+}
+
+static uint64_t mix(uint64_t hash, uint64_t value) {
+  hash ^= value * 0x9e3779b97f4a7c15;
+  return (hash << 31 | hash >> 33) * 0xbf58476d1ce4e5b9;
+}
+
+static uint64_t stateHash(const Registers& regs, const Memory& memory) {
+  uint64_t hash = mix(mix(0, static_cast<uint64_t>(regs.a | regs.x << 8 | regs.y << 16 | regs.sp.offset << 24)),
+                      static_cast<uint64_t>(regs.pc | static_cast<uint8_t>(regs.p) << 16));
+  for (auto it = memory.cbegin(); it != memory.cend(); it += sizeof(uint64_t)) {
+    uint64_t word;
+    std::memcpy(&word, it, sizeof word);
+    hash = mix(hash, word);
+  }
+  return hash;
+}
+
+static bool sameRegisters(const Registers& r1, const Registers& r2) {
+  return r1.a == r2.a && r1.x == r2.x && r1.y == r2.y && r1.pc == r2.pc && r1.sp.offset == r2.sp.offset &&
+         static_cast<uint8_t>(r1.p) == static_cast<uint8_t>(r2.p);
+}
+
+// Returns the number of cycles since the same state was sampled, 0 if it wasn't
+long HangDetector::sample(const Registers& regs, const Memory& memory, long cycle) {
+  auto resolved = regs;
+  resolved.p.resolveNZ();
+  const auto hash = stateHash(resolved, memory);
+  if (saved && hash == savedHash && sameRegisters(resolved, savedRegs) &&
+      std::equal(memory.cbegin(), memory.cend(), savedMemory->cbegin()))
+    return cycle - savedCycle;
+
+  if (!saved || ++length == power) {
+    power = saved ? power * 2 : 1;
+    length = 0;
+    saved = true;
+    savedHash = hash;
+    savedRegs = resolved;
+    std::copy(memory.cbegin(), memory.cend(), savedMemory->begin());
+    savedCycle = cycle;
+  }
+  return 0;
+}
+
+void HangDetector::reset() {
+  saved = false;
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include "addressrange.h"
+#include "memory.h"
+#include "registers.h"
+#include <memory>
+#include <string>
+
+enum class HangCause : uint8_t { Halted, Loop };
+
+struct HangReport {
+  HangCause cause;
+  AddressRange loop; // addresses of instructions executed in the loop, the halting one alone
+  long cycle;        // when detected
+  long period;       // cycles between two samples of the same state, a multiple of loop length; 0 when halted
+};
+
+std::string formatHangReport(const HangReport&);
+
+// Finds the machine coming back to a state it has been in before. The caller samples it at some interval and resets
+// the detector when anything from outside has happened in between (events, interrupts), so the run from one sample to
+// the next depends only on the state: the same state means the same samples again forever.
+// Samples are compared to a single saved one which is replaced after 1, 2, 4, ... samples (Brent's algorithm), a loop is
+// found at the latest within twice its own length after it starts. Hashes are compared first, then full state.
+class HangDetector {
+public:
+  long sample(const Registers&, const Memory&, long cycle);
+  void reset();
+
+private:
+  bool saved = false;
+  uint64_t savedHash;
+  Registers savedRegs;
+  std::unique_ptr<Memory> savedMemory = std::make_unique<Memory>();
+  long savedCycle;
+  long power;
+  long length;
+};
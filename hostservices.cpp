@@ -0,0 +1,161 @@
+#include "hostservices.h"
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <vector>
+
+static constexpr size_t MaxStringLength = 0x100;
+
+void HostCall::write(Address addr, uint8_t value) {
+  memory.write(addr, value);
+  written.expand(addr);
+}
+
+// bytes go through device handlers one at a time where the destination has any
+void HostCall::write(Address addr, const uint8_t* bytes, size_t length) {
+  if (!length) return;
+  const AddressRange range{addr, static_cast<Address>(addr + length - 1)};
+  if (memory.deviceIn(range)) {
+    for (size_t i = 0; i < length; i++) memory.write(static_cast<Address>(addr + i), bytes[i]);
+  } else {
+    std::memcpy(&memory[addr], bytes, length);
+  }
+  written.expand(range.first);
+  written.expand(range.last);
+}
+
+// bytes as the processor reads them, banked pages aren't next to each other
+std::vector<uint8_t> HostCall::bytes(Address addr, size_t length) const {
+  std::vector<uint8_t> copy(length);
+  for (size_t i = 0; i < length; i++) copy[i] = memory[static_cast<Address>(addr + i)];
+  return copy;
+}
+
+std::string HostCall::string(Address addr) const {
+  std::string str;
+  for (auto a = addr; memory[a] && str.size() < MaxStringLength; a++) str += static_cast<char>(memory[a]);
+  return str;
+}
+
+static void setResult(Registers& regs, uint16_t result) {
+  regs.a = static_cast<uint8_t>(result);
+  regs.x = static_cast<uint8_t>(result >> 8);
+  regs.p.negative = result & 0x8000;
+  regs.p.zero = !result;
+}
+
+static void multiply(HostCall& call) {
+  setResult(call.regs, static_cast<uint16_t>(call.regs.a * call.regs.x));
+  call.regs.p.carry = false;
+}
+
+static void divide(HostCall& call) {
+  const uint16_t dividend = static_cast<uint16_t>(call.regs.a | call.regs.x << 8);
+  const uint8_t divisor = call.regs.y;
+  call.regs.p.carry = !divisor;
+  if (!divisor) return;
+  setResult(call.regs, dividend / divisor);
+  call.regs.y = static_cast<uint8_t>(dividend % divisor);
+}
+
+static void copyMemory(HostCall& call) {
+  const auto source = call.word(call.block());
+  const auto destination = call.word(static_cast<Address>(call.block() + 2));
+  const auto length = std::min<size_t>(call.word(static_cast<Address>(call.block() + 4)),
+                                       Memory::Size - std::max(source, destination));
+  call.regs.p.carry = false;
+  const auto bytes = call.bytes(source, length);
+  call.write(destination, bytes.data(), length);
+}
+
+static std::string format(const HostCall& call) {
+  const auto fmt = call.string(call.word(call.block()));
+  auto arg = static_cast<Address>(call.block() + 2);
+  std::string out;
+  for (size_t i = 0; i < fmt.size(); i++) {
+    if (fmt[i] != '%') {
+      out += fmt[i];
+      continue;
+    }
+    const auto first = i++;
+    while (i < fmt.size() && std::strchr("-+ 0#", fmt[i])) i++;
+    while (i < fmt.size() && std::isdigit(static_cast<unsigned char>(fmt[i]))) i++;
+    if (i == fmt.size()) break;
+    const auto spec = fmt.substr(first, i - first + 1);
+    char buf[MaxStringLength + 32];
+    int n = 0;
+    switch (fmt[i]) {
+    case '%': n = std::snprintf(buf, sizeof buf, "%%"); break;
+    case 'c': n = std::snprintf(buf, sizeof buf, spec.c_str(), call.memory[arg]); break;
+    case 'd': n = std::snprintf(buf, sizeof buf, spec.c_str(), static_cast<int16_t>(call.word(arg))); break;
+    case 'u':
+    case 'x':
+    case 'X': n = std::snprintf(buf, sizeof buf, spec.c_str(), call.word(arg)); break;
+    case 's': n = std::snprintf(buf, sizeof buf, spec.c_str(), call.string(call.word(arg)).c_str()); break;
+    default: n = std::snprintf(buf, sizeof buf, "%s", spec.c_str()); break;
+    }
+    if (std::strchr("cduxXs", fmt[i])) arg += 2;
+    if (n > 0) out.append(buf, std::min(static_cast<size_t>(n), sizeof buf - 1));
+  }
+  return out;
+}
+
+static void readFile(HostCall& call) {
+  const auto buffer = call.word(static_cast<Address>(call.block() + 2));
+  const auto length = std::min<size_t>(call.word(static_cast<Address>(call.block() + 4)), Memory::Size - buffer);
+  std::ifstream file(call.string(call.word(call.block())), std::ios::binary);
+  call.regs.p.carry = !file;
+  std::vector<uint8_t> data(file ? length : 0);
+  file.read(reinterpret_cast<char*>(data.data()), static_cast<std::streamsize>(data.size()));
+  const auto size = static_cast<size_t>(file.gcount());
+  call.write(buffer, data.data(), size);
+  call.regs.x = static_cast<uint8_t>(size);
+  call.regs.y = static_cast<uint8_t>(size >> 8);
+}
+
+static void writeFile(HostCall& call) {
+  const auto buffer = call.word(static_cast<Address>(call.block() + 2));
+  const auto length = std::min<size_t>(call.word(static_cast<Address>(call.block() + 4)), Memory::Size - buffer);
+  std::ofstream file(call.string(call.word(call.block())), std::ios::binary);
+  const auto bytes = call.bytes(buffer, length);
+  file.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(length));
+  call.regs.p.carry = !file;
+}
+
+void HostServices::registerService(uint8_t number, HostService handler, long cost) {
+  services[number] = {std::move(handler), cost};
+}
+
+void HostServices::registerStandardServices(HostOutput output) {
+  if (!output) output = [](const std::string& str) {
+    std::fputs(str.c_str(), stdout);
+    std::fflush(stdout);
+  };
+  registerService(Multiply, multiply);
+  registerService(Divide, divide);
+  registerService(CopyMemory, copyMemory);
+  registerService(Print, [output](HostCall& call) {
+    const auto str = format(call);
+    output(str);
+    call.regs.a = static_cast<uint8_t>(std::min<size_t>(str.size(), 0xff));
+    call.regs.p.carry = false;
+  });
+  registerService(ReadFile, readFile);
+  registerService(WriteFile, writeFile);
+}
+
+void HostServices::unregisterService(uint8_t number) {
+  services[number] = {};
+}
+
+void HostServices::changeCost(uint8_t number, long cost) {
+  services[number].cost = cost;
+}
+
+bool HostServices::call(uint8_t number, HostCall& call) const {
+  if (!services[number].handler) return false;
+  services[number].handler(call);
+  return true;
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include "addressrange.h"
+#include "memory.h"
+#include "registers.h"
+#include <array>
+#include <functional>
+#include <string>
+#include <vector>
+
+// Registers and memory a host service takes its arguments from and returns its results in. Results are written as the
+// processor writes them, devices get them through their handlers and write protected pages keep their contents.
+struct HostCall {
+  Registers& regs;
+  Memory& memory;
+  AddressRange written; // changed by the service, code there is invalidated
+
+  Address block() const { return static_cast<Address>(regs.x | regs.y << 8); }
+  uint16_t word(Address addr) const { return memory.word(addr); }
+  void write(Address addr, uint8_t value);
+  void write(Address addr, const uint8_t* bytes, size_t length);
+  std::vector<uint8_t> bytes(Address addr, size_t length) const;
+  std::string string(Address addr) const;
+};
+
+using HostService = std::function<void(HostCall&)>;
+using HostOutput = std::function<void(const std::string&)>;
+
+// Services of the HCL #n trap opcode ($42, a halting one on NMOS 6502), n selects the service. A call costs the cycles
+// given for the service in addition to the 2 cycles of the opcode, calls of unregistered services halt as KIL.
+//
+// Standard services, X (lo) and Y (hi) point to parameter block of words where registers don't suffice, C is set on
+// failure:
+//   Multiply    A * X, product in A (lo) and X (hi)
+//   Divide      A (lo) X (hi) / Y, quotient in A and X, remainder in Y
+//   CopyMemory  source, destination, length; areas may overlap
+//   Print       format string, argument words; %c %d %u %x %X %s and %% with flags and width, A = printed length
+//   ReadFile    file name, buffer, maximum length; X and Y = length read
+//   WriteFile   file name, buffer, length
+class HostServices {
+public:
+  enum Standard : uint8_t { Multiply, Divide, CopyMemory, Print, ReadFile, WriteFile };
+
+  static constexpr long DefaultCost = 20;
+
+  bool registered(uint8_t number) const { return static_cast<bool>(services[number].handler); }
+  long cost(uint8_t number) const { return services[number].cost; }
+  void registerService(uint8_t number, HostService handler, long cost = DefaultCost);
+  void registerStandardServices(HostOutput output = {});
+  void unregisterService(uint8_t number);
+  void changeCost(uint8_t number, long cost);
+  bool call(uint8_t number, HostCall&) const;
+
+private:
+  struct Entry {
+    HostService handler;
+    long cost = 0;
+  };
+
+  std::array<Entry, 256> services;
+};
@@ -0,0 +1,87 @@
+#include "inputlog.h"
+#include <array>
+#include <iomanip>
+#include <istream>
+#include <ostream>
+#include <sstream>
+#include <string>
+
+static constexpr std::array<const char*, 10> KindNames{"reset", "nmi", "irq", "pc", "sp", "a", "x", "y", "memory", "device"};
+static constexpr const char* Header = "mo65x-inputs";
+
+void InputLog::startRecording(uint32_t seed) {
+  memorySeed = seed;
+  recordedInputs.clear();
+  currentMode = Mode::Recording;
+}
+
+void InputLog::startReplay() {
+  nextInput = 0;
+  nextRead = 0;
+  skipDeviceReads();
+  currentMode = Mode::Replaying;
+}
+
+void InputLog::add(Input input) {
+  if (recording()) recordedInputs.push_back(std::move(input));
+}
+
+long InputLog::nextCycle() const {
+  return replaying() && nextInput < recordedInputs.size() ? recordedInputs[nextInput].cycle : Never;
+}
+
+const Input& InputLog::next() {
+  const auto& input = recordedInputs[nextInput++];
+  skipDeviceReads();
+  return input;
+}
+
+void InputLog::skipDeviceReads() {
+  while (nextInput < recordedInputs.size() && recordedInputs[nextInput].kind == InputKind::DeviceRead) nextInput++;
+}
+
+// values read from devices are given back in the order they were read, a read of another address gets nothing
+std::optional<uint8_t> InputLog::nextDeviceRead(Address address) {
+  while (nextRead < recordedInputs.size() && recordedInputs[nextRead].kind != InputKind::DeviceRead) nextRead++;
+  if (nextRead == recordedInputs.size() || recordedInputs[nextRead].address != address) return std::nullopt;
+  return static_cast<uint8_t>(recordedInputs[nextRead++].value);
+}
+
+// one line per input: cycle, kind, address and value, then bytes written to memory, all but the cycle in hex
+void InputLog::save(std::ostream& os) const {
+  os << Header << ' ' << memorySeed << '\n' << std::hex << std::setfill('0');
+  for (const auto& input : recordedInputs) {
+    os << std::dec << input.cycle << ' ' << KindNames[static_cast<size_t>(input.kind)] << std::hex << ' '
+       << std::setw(4) << input.address << ' ' << std::setw(4) << input.value;
+    for (const auto byte : input.bytes) os << ' ' << std::setw(2) << static_cast<int>(byte);
+    os << '\n';
+  }
+}
+
+bool InputLog::load(std::istream& is) {
+  std::string header;
+  uint32_t seed;
+  if (!(is >> header >> seed) || header != Header) return false;
+  std::vector<Input> inputs;
+  std::string line;
+  std::getline(is, line);
+  while (std::getline(is, line)) {
+    if (line.empty()) continue;
+    std::istringstream ls(line);
+    Input input{};
+    std::string kind;
+    unsigned address, value, byte;
+    if (!(ls >> std::dec >> input.cycle >> kind >> std::hex >> address >> value)) return false;
+    const auto name = std::find(KindNames.begin(), KindNames.end(), kind);
+    if (name == KindNames.end()) return false;
+    input.kind = static_cast<InputKind>(name - KindNames.begin());
+    input.address = static_cast<Address>(address);
+    input.value = static_cast<uint16_t>(value);
+    while (ls >> byte) input.bytes.push_back(static_cast<uint8_t>(byte));
+    inputs.push_back(std::move(input));
+  }
+  memorySeed = seed;
+  recordedInputs = std::move(inputs);
+  currentMode = Mode::Off;
+  return true;
+}
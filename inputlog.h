@@ -0,0 +1,83 @@
+#pragma once
+
+#include "commondefs.h"
+#include "runlevel.h"
+#include <iosfwd>
+#include <limits>
+#include <optional>
+#include <vector>
+
+enum class InputKind : uint8_t {
+  Reset,
+  Nmi,
+  Irq,
+  ProgramCounter,
+  StackPointer,
+  Accumulator,
+  RegisterX,
+  RegisterY,
+  Memory,
+  DeviceRead
+};
+
+// Something from outside the emulated machine, stamped with the cycle it took effect at
+struct Input {
+  long cycle;
+  InputKind kind;
+  Address address = 0; // first byte written to memory or device read from
+  uint16_t value = 0;  // register value or value read from a device
+  Data bytes;          // written to memory
+};
+
+// Inputs of a run in the order they took effect, with the seed memory was filled from before it started. Replaying
+// them from the same start gives the same run: requests and edits are applied at their cycles, device reads return
+// the recorded values in the recorded order. Cycles count from the last reset or cleared statistics, as the CPU ones.
+class InputLog {
+public:
+  static constexpr long Never = std::numeric_limits<long>::max();
+
+  enum class Mode { Off, Recording, Replaying };
+
+  Mode mode() const { return currentMode; }
+  bool recording() const { return currentMode == Mode::Recording; }
+  bool replaying() const { return currentMode == Mode::Replaying; }
+  uint32_t seed() const { return memorySeed; }
+  const std::vector<Input>& inputs() const { return recordedInputs; }
+
+  void startRecording(uint32_t seed);
+  void startReplay();
+  void stop() { currentMode = Mode::Off; }
+  void add(Input);
+
+  long nextCycle() const;
+  const Input& next();
+  std::optional<uint8_t> nextDeviceRead(Address);
+
+  void save(std::ostream&) const;
+  bool load(std::istream&);
+
+private:
+  Mode currentMode = Mode::Off;
+  uint32_t memorySeed = 0;
+  std::vector<Input> recordedInputs;
+  size_t nextInput = 0;
+  size_t nextRead = 0;
+
+  void skipDeviceReads();
+};
+
+static constexpr InputKind inputKind(CpuRunLevel runLevel) {
+  switch (runLevel) {
+  case CpuRunLevel::PendingReset: return InputKind::Reset;
+  case CpuRunLevel::PendingNmi: return InputKind::Nmi;
+  default: return InputKind::Irq;
+  }
+}
+
+static constexpr CpuRunLevel runLevelOf(InputKind kind) {
+  switch (kind) {
+  case InputKind::Reset: return CpuRunLevel::PendingReset;
+  case InputKind::Nmi: return CpuRunLevel::PendingNmi;
+  default: return CpuRunLevel::PendingIrq;
+  }
+}
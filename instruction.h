@@ -16,12 +16,14 @@ struct Instruction {
     case ZeroPageX:
     case ZeroPageY:
     case IndexedIndirectX:
-    case IndirectIndexedY: return 2;
+    case IndirectIndexedY:
+    case ZeroPageIndirect: return 2;
 
     case Indirect:
     case Absolute:
     case AbsoluteX:
-    case AbsoluteY: return 3;
+    case AbsoluteY:
+    case AbsoluteIndexedIndirect: return 3;
     }
     return 0;
   }
@@ -40,3 +42,19 @@ struct Instruction {
     this->size = sizeForAddressingMode(mode);
   }
 };
+
+// documented instructions storing to their operand
+constexpr bool writesOperand(const Instruction& ins) {
+  switch (ins.type) {
+  case STA:
+  case STX:
+  case STY: return true;
+  case INC:
+  case DEC:
+  case ASL:
+  case LSR:
+  case ROL:
+  case ROR: return ins.mode != ImpliedOrAccumulator;
+  default: return false;
+  }
+}
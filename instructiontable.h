@@ -1,5 +1,6 @@
 #pragma once
 
+#include "cpuvariant.h"
 #include "instruction.h"
 #include <array>
 
@@ -48,6 +49,7 @@ constexpr std::array<Instruction, 256> InstructionTable = [] {
 
   arr[0x40] = {RTI, ImpliedOrAccumulator, 6};
   arr[0x41] = {EOR, IndexedIndirectX, 6};
+  arr[0x42] = {HCL, Immediate, 2}; // host call trap in place of KIL, see HostServices
   arr[0x45] = {EOR, ZeroPage, 3};
   arr[0x46] = {LSR, ZeroPage, 5};
   arr[0x48] = {PHA, ImpliedOrAccumulator, 3};
@@ -149,8 +151,8 @@ constexpr std::array<Instruction, 256> InstructionTable = [] {
   arr[0xd6] = {DEC, ZeroPageX, 6};
   arr[0xd8] = {CLD, ImpliedOrAccumulator, 2};
   arr[0xd9] = {CMP, AbsoluteY, 4};
-  arr[0xde] = {CMP, AbsoluteX, 4};
-  arr[0xdf] = {DEC, AbsoluteX, 7};
+  arr[0xdd] = {CMP, AbsoluteX, 4};
+  arr[0xde] = {DEC, AbsoluteX, 7};
 
   arr[0xe0] = {CPX, Immediate, 2};
   arr[0xe1] = {SBC, IndexedIndirectX, 6};
@@ -175,3 +177,111 @@ constexpr std::array<Instruction, 256> InstructionTable = [] {
 
   return arr;
 }();
+
+// NMOS 6502 with the stable undocumented opcodes, unstable ones (XAA, LXA, SHA, SHX, SHY, TAS, LAS) still halt
+
+constexpr std::array<Instruction, 256> UndocumentedInstructionTable = [] {
+  auto arr = InstructionTable;
+
+  constexpr struct {
+    InstructionType type;
+    uint8_t column;
+  } ReadModifyWrite[]{{SLO, 0x00}, {RLA, 0x20}, {SRE, 0x40}, {RRA, 0x60}, {DCP, 0xc0}, {ISC, 0xe0}};
+
+  for (const auto& rmw : ReadModifyWrite) {
+    arr[rmw.column | 0x03] = {rmw.type, IndexedIndirectX, 8};
+    arr[rmw.column | 0x07] = {rmw.type, ZeroPage, 5};
+    arr[rmw.column | 0x0f] = {rmw.type, Absolute, 6};
+    arr[rmw.column | 0x13] = {rmw.type, IndirectIndexedY, 8};
+    arr[rmw.column | 0x17] = {rmw.type, ZeroPageX, 6};
+    arr[rmw.column | 0x1b] = {rmw.type, AbsoluteY, 7};
+    arr[rmw.column | 0x1f] = {rmw.type, AbsoluteX, 7};
+  }
+
+  arr[0x83] = {SAX, IndexedIndirectX, 6};
+  arr[0x87] = {SAX, ZeroPage, 3};
+  arr[0x8f] = {SAX, Absolute, 4};
+  arr[0x97] = {SAX, ZeroPageY, 4};
+
+  arr[0xa3] = {LAX, IndexedIndirectX, 6};
+  arr[0xa7] = {LAX, ZeroPage, 3};
+  arr[0xaf] = {LAX, Absolute, 4};
+  arr[0xb3] = {LAX, IndirectIndexedY, 5};
+  arr[0xb7] = {LAX, ZeroPageY, 4};
+  arr[0xbf] = {LAX, AbsoluteY, 4};
+
+  arr[0x0b] = {ANC, Immediate, 2};
+  arr[0x2b] = {ANC, Immediate, 2};
+  arr[0x4b] = {ALR, Immediate, 2};
+  arr[0x6b] = {ARR, Immediate, 2};
+  arr[0xcb] = {SBX, Immediate, 2};
+  arr[0xeb] = {SBC, Immediate, 2};
+
+  for (const uint8_t opCode : {0x1a, 0x3a, 0x5a, 0x7a, 0xda, 0xfa}) arr[opCode] = {NOP, ImpliedOrAccumulator, 2};
+  for (const uint8_t opCode : {0x80, 0x82, 0x89, 0xc2, 0xe2}) arr[opCode] = {NOP, Immediate, 2};
+  for (const uint8_t opCode : {0x04, 0x44, 0x64}) arr[opCode] = {NOP, ZeroPage, 3};
+  for (const uint8_t opCode : {0x14, 0x34, 0x54, 0x74, 0xd4, 0xf4}) arr[opCode] = {NOP, ZeroPageX, 4};
+  arr[0x0c] = {NOP, Absolute, 4};
+  for (const uint8_t opCode : {0x1c, 0x3c, 0x5c, 0x7c, 0xdc, 0xfc}) arr[opCode] = {NOP, AbsoluteX, 4};
+
+  return arr;
+}();
+
+// WDC 65C02 without the Rockwell bit instructions, STP halts as KIL and other unused opcodes are NOPs except $42 kept
+// as host call trap
+
+constexpr std::array<Instruction, 256> Cmos65C02InstructionTable = [] {
+  auto arr = InstructionTable;
+
+  for (auto& ins : arr)
+    if (ins.type == KIL) ins = {NOP, ImpliedOrAccumulator, 1};
+
+  arr[0x12] = {ORA, ZeroPageIndirect, 5};
+  arr[0x32] = {AND, ZeroPageIndirect, 5};
+  arr[0x52] = {EOR, ZeroPageIndirect, 5};
+  arr[0x72] = {ADC, ZeroPageIndirect, 5};
+  arr[0x92] = {STA, ZeroPageIndirect, 5};
+  arr[0xb2] = {LDA, ZeroPageIndirect, 5};
+  arr[0xd2] = {CMP, ZeroPageIndirect, 5};
+  arr[0xf2] = {SBC, ZeroPageIndirect, 5};
+
+  arr[0x89] = {BIT, Immediate, 2};
+  arr[0x34] = {BIT, ZeroPageX, 4};
+  arr[0x3c] = {BIT, AbsoluteX, 4};
+  arr[0x04] = {TSB, ZeroPage, 5};
+  arr[0x0c] = {TSB, Absolute, 6};
+  arr[0x14] = {TRB, ZeroPage, 5};
+  arr[0x1c] = {TRB, Absolute, 6};
+  arr[0x1a] = {INC, ImpliedOrAccumulator, 2};
+  arr[0x3a] = {DEC, ImpliedOrAccumulator, 2};
+
+  arr[0x5a] = {PHY, ImpliedOrAccumulator, 3};
+  arr[0x7a] = {PLY, ImpliedOrAccumulator, 4};
+  arr[0xda] = {PHX, ImpliedOrAccumulator, 3};
+  arr[0xfa] = {PLX, ImpliedOrAccumulator, 4};
+
+  arr[0x80] = {BRA, Branch, 2};
+  arr[0x64] = {STZ, ZeroPage, 3};
+  arr[0x74] = {STZ, ZeroPageX, 4};
+  arr[0x9c] = {STZ, Absolute, 4};
+  arr[0x9e] = {STZ, AbsoluteX, 5};
+  arr[0x7c] = {JMP, AbsoluteIndexedIndirect, 6};
+
+  for (const uint8_t opCode : {0x02, 0x22, 0x62, 0x82, 0xc2, 0xe2}) arr[opCode] = {NOP, Immediate, 2};
+  arr[0x44] = {NOP, ZeroPage, 3};
+  for (const uint8_t opCode : {0x54, 0xd4, 0xf4}) arr[opCode] = {NOP, ZeroPageX, 4};
+  arr[0x5c] = {NOP, Absolute, 8};
+  for (const uint8_t opCode : {0xdc, 0xfc}) arr[opCode] = {NOP, Absolute, 4};
+  arr[0xdb] = {KIL, ImpliedOrAccumulator, 3};
+
+  return arr;
+}();
+
+constexpr const std::array<Instruction, 256>& instructionTable(CpuVariant variant) {
+  switch (variant) {
+  case CpuVariant::Nmos: break;
+  case CpuVariant::NmosUndocumented: return UndocumentedInstructionTable;
+  case CpuVariant::Cmos65C02: return Cmos65C02InstructionTable;
+  }
+  return InstructionTable;
+}
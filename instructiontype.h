@@ -58,5 +58,35 @@ enum InstructionType {
   PLA,
   PLP,
   NOP,
-  KIL
+  KIL,
+
+  // NMOS undocumented
+
+  SLO,
+  RLA,
+  SRE,
+  RRA,
+  SAX,
+  LAX,
+  DCP,
+  ISC,
+  ANC,
+  ALR,
+  ARR,
+  SBX,
+
+  // 65C02
+
+  BRA,
+  STZ,
+  PHX,
+  PHY,
+  PLX,
+  PLY,
+  TRB,
+  TSB,
+
+  // emulator host call trap
+
+  HCL
 };
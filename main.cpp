@@ -3,6 +3,8 @@
 #include "emulatorstate.h"
 #include "filedatastorage.h"
 #include "mainwindow.h"
+#include "memorydiff.h"
+#include "writehistory.h"
 #include <QApplication>
 #include <QDir>
 #include <QFile>
@@ -16,6 +18,8 @@ Q_DECLARE_METATYPE(Address)
 Q_DECLARE_METATYPE(AddressRange)
 Q_DECLARE_METATYPE(FileOperationCallBack)
 Q_DECLARE_METATYPE(Frequency)
+Q_DECLARE_METATYPE(MemoryDiff)
+Q_DECLARE_METATYPE(std::vector<WriteHistory::Write>)
 
 int main(int argc, char* argv[]) {
 
@@ -30,6 +34,8 @@ int main(int argc, char* argv[]) {
   qRegisterMetaType<Data>();
   qRegisterMetaType<AddressRange>();
   qRegisterMetaType<FileOperationCallBack>();
+  qRegisterMetaType<MemoryDiff>();
+  qRegisterMetaType<std::vector<WriteHistory::Write>>();
 
   QApplication app(argc, argv);
   QApplication::setStyle(QStyleFactory::create("Fusion"));
@@ -18,6 +18,9 @@ MainWindow::MainWindow(QWidget* parent) : QMainWindow(parent), ui(new Ui::MainWi
   videoWidget = new VideoWidget(this, emulator->memoryView());
   this->addDockWidget(Qt::LeftDockWidgetArea, videoWidget);
 
+  memorySearchWidget = new MemorySearchWidget(this, emulator->memoryView());
+  this->addDockWidget(Qt::LeftDockWidgetArea, memorySearchWidget);
+
   assemblerWidget = new AssemblerWidget(this, emulator->memoryRef());
   memoryWidget = new MemoryWidget(this, emulator->memoryView());
   disassemblerWidget = new DisassemblerWidget(this, emulator->memoryView());
@@ -29,6 +32,8 @@ MainWindow::MainWindow(QWidget* parent) : QMainWindow(parent), ui(new Ui::MainWi
   connect(pollTimer, &QTimer::timeout, this, &MainWindow::polling);
 
   connect(cpuWidget, &CpuWidget::executionRequested, emulator, &Emulator::execute);
+  connect(cpuWidget, &CpuWidget::stepBackRequested, emulator, &Emulator::stepBack);
+  connect(cpuWidget, &CpuWidget::runBackRequested, emulator, &Emulator::runBackTo);
   connect(cpuWidget, &CpuWidget::programCounterChanged, emulator, &Emulator::changeProgramCounter);
   connect(cpuWidget, &CpuWidget::stackPointerChanged, emulator, &Emulator::changeStackPointer);
   connect(cpuWidget, &CpuWidget::registerAChanged, emulator, &Emulator::changeAccumulator);
@@ -43,6 +48,7 @@ MainWindow::MainWindow(QWidget* parent) : QMainWindow(parent), ui(new Ui::MainWi
 
   connect(emulator, &Emulator::stateChanged, cpuWidget, &CpuWidget::updateState);
   connect(emulator, &Emulator::stateChanged, disassemblerWidget, &DisassemblerWidget::updateState);
+  connect(emulator, &Emulator::stateChanged, memoryWidget, &MemoryWidget::updateState);
   connect(emulator, &Emulator::memoryContentChanged, cpuWidget, &CpuWidget::updateOnChange);
   connect(emulator, &Emulator::memoryContentChanged, memoryWidget, &MemoryWidget::updateOnChange);
   connect(emulator, &Emulator::memoryContentChanged, disassemblerWidget, &DisassemblerWidget::updateOnChange);
@@ -53,11 +59,23 @@ MainWindow::MainWindow(QWidget* parent) : QMainWindow(parent), ui(new Ui::MainWi
   connect(assemblerWidget, &AssemblerWidget::fileLoaded, this, &MainWindow::changeAsmFileName);
   connect(assemblerWidget, &AssemblerWidget::fileSaved, this, &MainWindow::changeAsmFileName);
   connect(assemblerWidget, &AssemblerWidget::operationCompleted, this, &MainWindow::showMessage);
-  connect(assemblerWidget, &AssemblerWidget::codeWritten, emulator, &Emulator::memoryContentChanged);
+  connect(assemblerWidget, &AssemblerWidget::codeWritten, emulator, &Emulator::updateOnChange);
   connect(assemblerWidget, &AssemblerWidget::programCounterChanged, emulator, &Emulator::changeProgramCounter);
 
   connect(memoryWidget, &MemoryWidget::loadFromFileRequested, emulator, &Emulator::loadMemoryFromFile);
   connect(memoryWidget, &MemoryWidget::saveToFileRequested, emulator, &Emulator::saveMemoryToFile);
+  connect(memoryWidget, &MemoryWidget::markRequested, emulator, &Emulator::markMemory);
+  connect(memoryWidget, &MemoryWidget::diffRequested, emulator, &Emulator::diffMemory);
+  connect(memoryWidget, &MemoryWidget::recordingRequested, emulator, [&] { emulator->startRecording(); });
+  connect(memoryWidget, &MemoryWidget::inputLogStopRequested, emulator, &Emulator::stopInputLog);
+  connect(memoryWidget, &MemoryWidget::saveRecordingRequested, emulator, &Emulator::saveRecording);
+  connect(memoryWidget, &MemoryWidget::replayRequested, emulator, &Emulator::replayRecording);
+  connect(emulator, &Emulator::memoryDiffed, memoryWidget, &MemoryWidget::showDiff);
+  connect(memoryWidget, &MemoryWidget::writeHistoryChangeRequested, emulator, &Emulator::changeWriteHistory);
+  connect(memoryWidget, &MemoryWidget::writesRequested, emulator, &Emulator::findWrites);
+  connect(emulator, &Emulator::writesFound, memoryWidget, &MemoryWidget::showWrites);
+
+  connect(memorySearchWidget, &MemorySearchWidget::operationCompleted, this, &MainWindow::showMessage);
 
   connect(disassemblerWidget, &DisassemblerWidget::goToStartClicked, emulator, &Emulator::changeProgramCounter);
 
@@ -115,6 +133,7 @@ void MainWindow::propagateState(EmulatorState es) {
 
   if (viewWidget->isVisible(memoryWidget)) {
     const QSignalBlocker memoryBlocker(this->memoryWidget);
+    memoryWidget->updateState(es);
     memoryWidget->updateOnChange(AddressRange::Max);
   }
 
@@ -129,6 +148,8 @@ void MainWindow::propagateState(EmulatorState es) {
 
   const QSignalBlocker videoBlocker(this->videoWidget);
   videoWidget->updateView();
+
+  memorySearchWidget->updateOnFrame();
 }
 
 void MainWindow::polling() {
@@ -8,6 +8,7 @@
 #include "disassemblerwidget.h"
 #include "emulator.h"
 #include "filedatastorage.h"
+#include "memorysearchwidget.h"
 #include "memorywidget.h"
 #include "videowidget.h"
 #include <QMainWindow>
@@ -41,6 +42,7 @@ private:
   DisassemblerWidget* disassemblerWidget;
   CpuWidget* cpuWidget;
   VideoWidget* videoWidget;
+  MemorySearchWidget* memorySearchWidget;
   Emulator* emulator;
   FileDataStorage<Config>* configStorage;
   Config config;
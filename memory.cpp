@@ -1 +1,106 @@
 #include "memory.h"
+#include <algorithm>
+
+Memory::Memory() {
+  for (size_t page = 0; page < NumberOfPages; page++) pages[page] = data + page * PageSize;
+}
+
+bool Memory::deviceIn(AddressRange range) const {
+  if (!range.valid()) return false;
+  for (int page = range.first >> 8; page <= range.last >> 8; page++)
+    if (device(static_cast<Address>(page << 8))) return true;
+  return false;
+}
+
+void Memory::touch(AddressRange range) {
+  if (!range.valid()) return;
+  std::fill(pageGenerations.begin() + (range.first >> 8), pageGenerations.begin() + (range.last >> 8) + 1,
+            currentGeneration);
+}
+
+Memory::PageSet Memory::changedPages(Generation since) const {
+  PageSet pages;
+  for (size_t page = 0; page < NumberOfPages; page++) pages[page] = pageGenerations[page] >= since;
+  return pages;
+}
+
+// runs of changed pages
+std::vector<AddressRange> Memory::changedRanges(Generation since) const {
+  const auto pages = changedPages(since);
+  std::vector<AddressRange> ranges;
+  for (size_t page = 0; page < NumberOfPages; page++) {
+    if (!pages[page]) continue;
+    const auto first = static_cast<Address>(page * PageSize);
+    const auto last = static_cast<Address>(page * PageSize + PageSize - 1);
+    if (page && pages[page - 1])
+      ranges.back().last = last;
+    else
+      ranges.emplace_back(first, last);
+  }
+  return ranges;
+}
+
+void Memory::mapDevice(uint8_t firstPage, uint8_t lastPage, ReadHandler read, WriteHandler write) {
+  unmapDevice(firstPage, lastPage);
+  for (int page = firstPage; page <= lastPage; page++) {
+    devices[page] = {read, write};
+    assign(readPages, page, static_cast<bool>(read));
+    assign(writePages, page, true);
+  }
+}
+
+// the image holds the pages from the first one on, it stays owned by the caller until the pages are unmapped
+void Memory::mapBank(uint8_t firstPage, uint8_t lastPage, uint8_t* image) {
+  unmapDevice(firstPage, lastPage);
+  for (int page = firstPage; page <= lastPage; page++) {
+    pages[static_cast<size_t>(page)] = image + (page - firstPage) * PageSize;
+    assign(readPages, page, true);
+    assign(writePages, page, true);
+    assign(bankPages, page, true);
+  }
+  banks = true;
+}
+
+// devices and banks, the pages are RAM again
+void Memory::unmapDevice(uint8_t firstPage, uint8_t lastPage) {
+  for (int page = firstPage; page <= lastPage; page++) {
+    devices[page] = {};
+    pages[static_cast<size_t>(page)] = data + page * PageSize;
+    assign(readPages, page, false);
+    assign(writePages, page, false);
+    assign(bankPages, page, false);
+  }
+  banks = std::any_of(bankPages.begin(), bankPages.end(), [](auto bits) { return bits; });
+  deviceAccessCount++;
+}
+
+void Memory::mapPort(WriteHandler write) {
+  portEnd = write ? 2 : 0;
+  portWrite = std::move(write);
+  deviceAccessCount++;
+}
+
+void Memory::assign(PageBits& bits, int page, bool value) {
+  const auto mask = uint64_t(1) << (page & 63);
+  auto& word = bits[static_cast<size_t>(page >> 6)];
+  if (value)
+    word |= mask;
+  else
+    word &= ~mask;
+}
+
+uint8_t Memory::readDevice(Address addr) {
+  if (test(bankPages, addr)) return banked(addr);
+  deviceAccessCount++;
+  const auto value = devices[addr >> 8].read(addr);
+  return readFilter ? readFilter(addr, value) : value;
+}
+
+void Memory::writeDevice(Address addr, uint8_t value) {
+  const auto& dev = devices[addr >> 8];
+  if (dev.write)
+    dev.write(addr, value);
+  else if (test(bankPages, addr))
+    data[addr] = value;
+  touch(addr);
+}
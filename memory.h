@@ -1,16 +1,49 @@
 #pragma once
 
+#include "addressrange.h"
 #include "commondefs.h"
+#include <array>
+#include <bitset>
 #include <iterator>
+#include <vector>
 
+// 64 KB seen by the processor, split into 256 pages. RAM pages are the flat array, device pages have their reads and
+// writes passed to handlers instead. The processor accesses memory through read() and write(), which test a single bit
+// per access to find out whether the page belongs to a device. Write protected pages are devices without handlers:
+// they are read directly and ignore writes.
+//
+// Pages are reached through a table of page pointers, a bank maps pages to an image kept outside the array, so
+// switching banks sets pointers and copies nothing, and images of any total size can be switched in turn. Banked pages
+// are read from the image and write protected, their writes go to the RAM under them. The subscript operator sees what
+// the processor reads, without side effects, and looks the page up only while any bank is mapped, so fetches without
+// banks cost as before. Iterators reach the RAM array: loaders, snapshots and comparisons work on RAM, also where a
+// bank hides it.
+//
+// The 6510 port at $00 and $01 is plain memory with a handler told of each write, so the rest of the zero page is
+// written as any RAM.
+//
+// Pages written by the processor are stamped with the current generation. A consumer starts a generation, keeps its
+// number and later asks which pages have been written since, other writes are to be reported with touch().
 class Memory {
 public:
   static constexpr size_t Size = 0x10000;
+  static constexpr size_t PageSize = 0x100;
+  static constexpr size_t NumberOfPages = Size / PageSize;
+
+  using Generation = uint64_t;
+  using PageSet = std::bitset<NumberOfPages>;
+  using ReadHandler = std::function<uint8_t(Address)>;
+  using WriteHandler = std::function<void(Address, uint8_t)>;
+  using ReadFilter = std::function<uint8_t(Address, uint8_t)>;
+
+  Memory();
+  Memory(const Memory&) = delete;
+  Memory& operator=(const Memory&) = delete;
 
   auto size() const { return Size; }
 
-  uint8_t& operator[](Address address) { return data[address]; }
-  const uint8_t& operator[](Address address) const { return data[address]; }
+  uint8_t& operator[](Address address) { return banks ? banked(address) : data[address]; }
+  const uint8_t& operator[](Address address) const { return banks ? banked(address) : data[address]; }
 
   auto begin() { return std::begin(data); }
   auto end() { return std::end(data); }
@@ -18,13 +51,74 @@ public:
   auto cbegin() const { return std::cbegin(data); }
   auto cend() const { return std::cend(data); }
 
-  uint16_t word(Address addr) const { return static_cast<uint16_t>(data[addr] | data[addr + 1] << 8); }
+  uint16_t word(Address addr) const {
+    return static_cast<uint16_t>((*this)[addr] | (*this)[static_cast<Address>(addr + 1)] << 8);
+  }
 
   void setWord(Address addr, uint16_t val) {
-    data[addr] = static_cast<uint8_t>(val);
-    data[addr + 1] = val >> 8;
+    (*this)[addr] = static_cast<uint8_t>(val);
+    (*this)[static_cast<Address>(addr + 1)] = val >> 8;
+  }
+
+  bool device(Address addr) const { return test(writePages, addr) || addr < portEnd; }
+  bool deviceIn(AddressRange) const;
+
+  // reads from devices and map changes, anything that may make memory read other than its contents tell
+  uint64_t deviceAccesses() const { return deviceAccessCount; }
+
+  uint8_t read(Address addr) { return test(readPages, addr) ? readDevice(addr) : data[addr]; }
+
+  void write(Address addr, uint8_t value) {
+    if (test(writePages, addr))
+      writeDevice(addr, value);
+    else {
+      data[addr] = value;
+      touch(addr);
+      if (addr < portEnd) portWrite(addr, value);
+    }
   }
 
+  Generation generation() const { return currentGeneration; }
+  Generation startGeneration() { return ++currentGeneration; }
+  void touch(Address addr) { pageGenerations[addr >> 8] = currentGeneration; }
+  void touch(AddressRange);
+  PageSet changedPages(Generation since) const;
+  std::vector<AddressRange> changedRanges(Generation since) const;
+
+  void mapDevice(uint8_t firstPage, uint8_t lastPage, ReadHandler, WriteHandler);
+  void unmapDevice(uint8_t firstPage, uint8_t lastPage);
+  void writeProtect(uint8_t firstPage, uint8_t lastPage) { mapDevice(firstPage, lastPage, {}, {}); }
+  void mapBank(uint8_t firstPage, uint8_t lastPage, uint8_t* image);
+  void mapPort(WriteHandler);
+
+  // sees every value read from a device and may replace it, to record device input or to play it back
+  void filterDeviceReads(ReadFilter filter) { readFilter = std::move(filter); }
+
 private:
-  uint8_t data[Size];
+  struct Device {
+    ReadHandler read;   // reads come from the array when not given
+    WriteHandler write; // writes are ignored when not given
+  };
+
+  using PageBits = std::array<uint64_t, NumberOfPages / 64>;
+
+  uint8_t data[Size]{};
+  std::array<uint8_t*, NumberOfPages> pages; // into the array or into banked images
+  PageBits readPages{};  // pages with read handler or banked
+  PageBits writePages{}; // all device pages
+  PageBits bankPages{};  // pages read from an image, written to the array
+  bool banks = false;    // any bank mapped, pages are looked up only then
+  std::array<Device, NumberOfPages> devices;
+  ReadFilter readFilter;
+  WriteHandler portWrite;
+  Address portEnd = 0; // past the port bytes, 0 without port
+  uint64_t deviceAccessCount = 0;
+  std::array<Generation, NumberOfPages> pageGenerations{};
+  Generation currentGeneration = 0;
+
+  static bool test(const PageBits& bits, Address addr) { return bits[addr >> 14] >> (addr >> 8 & 63) & 1; }
+  uint8_t& banked(Address addr) const { return pages[addr >> 8][addr & 0xff]; }
+  static void assign(PageBits& bits, int page, bool value);
+  uint8_t readDevice(Address);
+  void writeDevice(Address, uint8_t);
 };
@@ -0,0 +1,57 @@
+#include "memorydiff.h"
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+static constexpr size_t BlockSize = 64;
+
+// bit i set when byte i of the block differs
+static uint64_t differingBytes(const uint8_t* before, const uint8_t* after) {
+  uint64_t equal = 0;
+#ifdef __SSE2__
+  for (size_t lane = 0; lane < BlockSize; lane += 16) {
+    const auto beforeLanes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(before + lane));
+    const auto afterLanes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(after + lane));
+    equal |= static_cast<uint64_t>(static_cast<uint16_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(beforeLanes, afterLanes)))) << lane;
+  }
+#else
+  for (size_t i = 0; i < BlockSize; i++) equal |= static_cast<uint64_t>(before[i] == after[i]) << i;
+#endif
+  return ~equal;
+}
+
+MemoryDiff::MemoryDiff(const Snapshot& before, const Snapshot& after) {
+  for (size_t page = 0; page < Memory::NumberOfPages; page++)
+    if (before.pages[page] != after.pages[page]) comparePage(page, before.pages[page]->data(), after.pages[page]->data());
+  collectRanges();
+}
+
+MemoryDiff::MemoryDiff(const Snapshot& before, const Memory& after) {
+  for (size_t page = 0; page < Memory::NumberOfPages; page++)
+    comparePage(page, before.pages[page]->data(), after.cbegin() + page * Memory::PageSize);
+  collectRanges();
+}
+
+size_t MemoryDiff::count() const {
+  size_t total = 0;
+  for (const auto range : changedRanges) total += range.size();
+  return total;
+}
+
+void MemoryDiff::comparePage(size_t page, const uint8_t* before, const uint8_t* after) {
+  for (size_t offset = 0; offset < Memory::PageSize; offset += BlockSize)
+    changedBytes[(page * Memory::PageSize + offset) / BlockSize] = differingBytes(before + offset, after + offset);
+}
+
+void MemoryDiff::collectRanges() {
+  for (size_t block = 0; block < changedBytes.size(); block++) {
+    for (size_t bit = 0; bit < BlockSize && changedBytes[block] >> bit; bit++) {
+      if (!(changedBytes[block] >> bit & 1)) continue;
+      const auto addr = static_cast<Address>(block * BlockSize + bit);
+      if (!changedRanges.empty() && changedRanges.back().last + 1 == addr)
+        changedRanges.back().last = addr;
+      else
+        changedRanges.push_back({addr, addr});
+    }
+  }
+}
@@ -0,0 +1,29 @@
+#pragma once
+
+#include "addressrange.h"
+#include "memory.h"
+#include "snapshot.h"
+#include <array>
+#include <vector>
+
+// Bytes differing between two snapshots or between a snapshot and memory, as bits and as ranges of consecutive bytes.
+// A page shared by two snapshots is the same without looking at it, other pages are compared 64 bytes at a time, with
+// SSE2 where available.
+class MemoryDiff {
+public:
+  MemoryDiff() = default;
+  MemoryDiff(const Snapshot& before, const Snapshot& after);
+  MemoryDiff(const Snapshot& before, const Memory& after);
+
+  bool empty() const { return changedRanges.empty(); }
+  size_t count() const;
+  bool contains(Address addr) const { return changedBytes[addr >> 6] >> (addr & 63) & 1; }
+  const std::vector<AddressRange>& ranges() const { return changedRanges; }
+
+private:
+  std::array<uint64_t, Memory::Size / 64> changedBytes{};
+  std::vector<AddressRange> changedRanges;
+
+  void comparePage(size_t page, const uint8_t* before, const uint8_t* after);
+  void collectRanges();
+};
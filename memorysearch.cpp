@@ -0,0 +1,204 @@
+#include "memorysearch.h"
+#include <bitset>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+namespace {
+
+constexpr size_t BlockSize = 64;
+
+// Tests of a current value against the previous one, in a scalar form and a vector form setting the passed lanes to
+// all ones
+
+#ifdef __SSE2__
+__m128i inverted(__m128i lanes) {
+  return _mm_xor_si128(lanes, _mm_set1_epi8(-1));
+}
+#endif
+
+struct Masked {
+  uint8_t value;
+  uint8_t mask;
+  template <typename T> bool operator()(T current, T) const { return (current & mask) == value; }
+#ifdef __SSE2__
+  __m128i operator()(__m128i current, __m128i) const {
+    return _mm_cmpeq_epi8(_mm_and_si128(current, _mm_set1_epi8(static_cast<char>(mask))), _mm_set1_epi8(static_cast<char>(value)));
+  }
+#endif
+};
+
+struct Same {
+  template <typename T> bool operator()(T current, T previous) const { return current == previous; }
+#ifdef __SSE2__
+  __m128i operator()(__m128i current, __m128i previous) const { return _mm_cmpeq_epi8(current, previous); }
+#endif
+};
+
+struct Different {
+  template <typename T> bool operator()(T current, T previous) const { return current != previous; }
+#ifdef __SSE2__
+  __m128i operator()(__m128i current, __m128i previous) const { return inverted(_mm_cmpeq_epi8(current, previous)); }
+#endif
+};
+
+struct Greater {
+  template <typename T> bool operator()(T current, T previous) const { return current > previous; }
+#ifdef __SSE2__
+  __m128i operator()(__m128i current, __m128i previous) const {
+    return inverted(_mm_cmpeq_epi8(_mm_min_epu8(current, previous), current));
+  }
+#endif
+};
+
+struct Less {
+  template <typename T> bool operator()(T current, T previous) const { return current < previous; }
+#ifdef __SSE2__
+  __m128i operator()(__m128i current, __m128i previous) const {
+    return inverted(_mm_cmpeq_epi8(_mm_min_epu8(current, previous), previous));
+  }
+#endif
+};
+
+struct Offset {
+  int delta;
+  template <typename T> bool operator()(T current, T previous) const { return current == static_cast<T>(previous + delta); }
+#ifdef __SSE2__
+  __m128i operator()(__m128i current, __m128i previous) const {
+    return _mm_cmpeq_epi8(current, _mm_add_epi8(previous, _mm_set1_epi8(static_cast<char>(delta))));
+  }
+#endif
+};
+
+// bit i set when byte i of the block passes the test
+template <typename Test>
+uint64_t passed(const uint8_t* current, const uint8_t* previous, Test test) {
+  uint64_t bits = 0;
+#ifdef __SSE2__
+  for (size_t lane = 0; lane < BlockSize; lane += 16) {
+    const auto currentLanes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(current + lane));
+    const auto previousLanes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(previous + lane));
+    bits |= static_cast<uint64_t>(static_cast<uint16_t>(_mm_movemask_epi8(test(currentLanes, previousLanes)))) << lane;
+  }
+#else
+  for (size_t i = 0; i < BlockSize; i++) bits |= static_cast<uint64_t>(test(current[i], previous[i])) << i;
+#endif
+  return bits;
+}
+
+template <typename Bits, typename BlockTest>
+void keep(Bits& bits, BlockTest blockTest) {
+  for (size_t block = 0; block < bits.size(); block++)
+    if (bits[block]) bits[block] &= blockTest(block * BlockSize);
+}
+
+uint16_t word(const uint8_t* values, size_t addr) {
+  return static_cast<uint16_t>(values[addr] | values[addr + 1] << 8);
+}
+
+template <typename Bits, typename Test>
+void keepWords(Bits& bits, const uint8_t* current, const uint8_t* previous, Test test) {
+  for (size_t block = 0; block < bits.size(); block++) {
+    for (size_t bit = 0; bit < BlockSize && bits[block] >> bit; bit++) {
+      const auto addr = block * BlockSize + bit;
+      if (!test(word(current, addr), word(previous, addr))) bits[block] &= ~(uint64_t(1) << bit);
+    }
+  }
+}
+
+} // namespace
+
+MemorySearch::MemorySearch() : previous(Memory::Size + MaxPatternSize), current(Memory::Size + MaxPatternSize) {
+}
+
+size_t MemorySearch::count() const {
+  size_t total = 0;
+  for (const auto bits : candidates) total += std::bitset<64>(bits).count();
+  return total;
+}
+
+std::vector<Address> MemorySearch::addresses(size_t limit) const {
+  std::vector<Address> found;
+  for (size_t block = 0; block < candidates.size() && found.size() < limit; block++) {
+    for (size_t bit = 0; bit < BlockSize && candidates[block] >> bit && found.size() < limit; bit++)
+      if (candidates[block] >> bit & 1) found.push_back(static_cast<Address>(block * BlockSize + bit));
+  }
+  return found;
+}
+
+uint16_t MemorySearch::value(Address addr, SearchSize size) const {
+  return size == SearchSize::Byte ? previous[addr] : word(previous.data(), addr);
+}
+
+void MemorySearch::start(const Memory& memory) {
+  take(memory);
+  std::swap(previous, current);
+  candidates.fill(~uint64_t(0));
+}
+
+bool MemorySearch::narrow(const Memory& memory, const SearchPattern& pattern) {
+  if (pattern.bytes.empty() || pattern.bytes.size() > MaxPatternSize ||
+      (!pattern.masks.empty() && pattern.masks.size() != pattern.bytes.size()))
+    return false;
+
+  std::array<Masked, MaxPatternSize> tests;
+  for (size_t i = 0; i < pattern.bytes.size(); i++) {
+    const auto mask = pattern.masks.empty() ? uint8_t(0xff) : pattern.masks[i];
+    tests[i] = {static_cast<uint8_t>(pattern.bytes[i] & mask), mask};
+  }
+  take(memory);
+  const auto values = current.data();
+  keep(candidates, [&](size_t first) {
+    auto bits = ~uint64_t(0);
+    for (size_t i = 0; i < pattern.bytes.size() && bits; i++) bits &= passed(values + first + i, values + first + i, tests[i]);
+    return bits;
+  });
+  std::swap(previous, current);
+  return true;
+}
+
+void MemorySearch::narrow(const Memory& memory, SearchCondition condition, SearchSize size, int operand) {
+  if (size == SearchSize::Word && condition == SearchCondition::EqualTo) {
+    narrow(memory, {{static_cast<uint8_t>(operand), static_cast<uint8_t>(operand >> 8)}, {}});
+    return;
+  }
+
+  take(memory);
+  const auto now = current.data();
+  const auto before = previous.data();
+  const auto bytes = [&](auto test) { keep(candidates, [&](size_t first) { return passed(now + first, before + first, test); }); };
+  if (size == SearchSize::Byte) {
+    switch (condition) {
+    case SearchCondition::EqualTo: bytes(Masked{static_cast<uint8_t>(operand), 0xff}); break;
+    case SearchCondition::Changed: bytes(Different()); break;
+    case SearchCondition::Unchanged: bytes(Same()); break;
+    case SearchCondition::Increased: bytes(Greater()); break;
+    case SearchCondition::Decreased: bytes(Less()); break;
+    case SearchCondition::ChangedBy: bytes(Offset{operand}); break;
+    }
+  } else {
+    // a word changed when either of its bytes did
+    switch (condition) {
+    case SearchCondition::EqualTo: break;
+    case SearchCondition::Changed:
+      keep(candidates, [&](size_t first) {
+        return passed(now + first, before + first, Different()) | passed(now + first + 1, before + first + 1, Different());
+      });
+      break;
+    case SearchCondition::Unchanged:
+      keep(candidates, [&](size_t first) {
+        return passed(now + first, before + first, Same()) & passed(now + first + 1, before + first + 1, Same());
+      });
+      break;
+    case SearchCondition::Increased: keepWords(candidates, now, before, Greater()); break;
+    case SearchCondition::Decreased: keepWords(candidates, now, before, Less()); break;
+    case SearchCondition::ChangedBy: keepWords(candidates, now, before, Offset{operand}); break;
+    }
+  }
+  std::swap(previous, current);
+}
+
+void MemorySearch::take(const Memory& memory) {
+  std::copy(memory.cbegin(), memory.cend(), current.begin());
+  std::copy_n(memory.cbegin(), MaxPatternSize, current.begin() + Memory::Size);
+}
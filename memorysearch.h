@@ -0,0 +1,46 @@
+#pragma once
+
+#include "commondefs.h"
+#include "memory.h"
+#include <array>
+#include <vector>
+
+// Bytes looked for, only the bits set in the mask of each byte are compared, all of them when no masks are given
+struct SearchPattern {
+  Data bytes;
+  Data masks;
+};
+
+enum class SearchCondition : uint8_t { EqualTo, Changed, Unchanged, Increased, Decreased, ChangedBy };
+
+enum class SearchSize : uint8_t { Byte, Word };
+
+// Addresses still matching after a series of looks at memory, the way cheat finders narrow down where a program keeps
+// a value. Each look copies memory and compares it with the previous copy or with a pattern 64 bytes at a time, giving
+// one word of candidate bits per block, blocks without candidates left are skipped. Byte comparisons, word patterns and
+// changed or unchanged words use SSE2 where available, words compared as numbers are tested one candidate at a time.
+class MemorySearch {
+public:
+  static constexpr size_t MaxPatternSize = 16;
+
+  MemorySearch();
+
+  size_t count() const;
+  bool contains(Address addr) const { return candidates[addr >> 6] >> (addr & 63) & 1; }
+  std::vector<Address> addresses(size_t limit) const;
+  uint16_t value(Address, SearchSize) const;
+
+  void start(const Memory&);
+  bool narrow(const Memory&, const SearchPattern&);
+  void narrow(const Memory&, SearchCondition, SearchSize, int operand = 0);
+
+private:
+  using Bits = std::array<uint64_t, Memory::Size / 64>;
+  using Values = std::vector<uint8_t>; // memory followed by its first bytes, values at the end wrap as Memory::word()
+
+  Bits candidates{};
+  Values previous;
+  Values current;
+
+  void take(const Memory&);
+};
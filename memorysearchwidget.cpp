@@ -0,0 +1,90 @@
+#include "memorysearchwidget.h"
+#include "commonformatters.h"
+#include "ui_memorysearchwidget.h"
+#include "uitools.h"
+#include <optional>
+
+// bytes as two hex digits and words as four, stored low byte first, ? for a digit matching anything
+static std::optional<SearchPattern> parsePattern(const QString& text) {
+  const auto simplified = text.simplified();
+  if (simplified.isEmpty()) return std::nullopt;
+
+  SearchPattern pattern;
+  for (const auto& token : simplified.split(' ')) {
+    if (token.size() != 2 && token.size() != 4) return std::nullopt;
+    uint16_t value = 0;
+    uint16_t mask = 0;
+    for (const auto digit : token) {
+      bool ok = digit == '?';
+      const auto nibble = ok ? 0 : QString(digit).toUInt(&ok, 16);
+      if (!ok) return std::nullopt;
+      value = static_cast<uint16_t>(value << 4 | nibble);
+      mask = static_cast<uint16_t>(mask << 4 | (digit == '?' ? 0 : 0xf));
+    }
+    pattern.bytes.push_back(static_cast<uint8_t>(value));
+    pattern.masks.push_back(static_cast<uint8_t>(mask));
+    if (token.size() == 4) {
+      pattern.bytes.push_back(static_cast<uint8_t>(value >> 8));
+      pattern.masks.push_back(static_cast<uint8_t>(mask >> 8));
+    }
+  }
+  if (pattern.bytes.size() > MemorySearch::MaxPatternSize) return std::nullopt;
+  return pattern;
+}
+
+MemorySearchWidget::MemorySearchWidget(QWidget* parent, const Memory& memory)
+    : QDockWidget(parent), ui(new Ui::MemorySearchWidget), memory(memory) {
+  ui->setupUi(this);
+  connect(ui->find, &QAbstractButton::clicked, this, &MemorySearchWidget::find);
+  connect(ui->pattern, &QLineEdit::returnPressed, this, &MemorySearchWidget::find);
+  connect(ui->start, &QAbstractButton::clicked, this, &MemorySearchWidget::start);
+  connect(ui->narrow, &QAbstractButton::clicked, this, &MemorySearchWidget::narrow);
+  connect(ui->size, QOverload<int>::of(&QComboBox::currentIndexChanged), this, &MemorySearchWidget::updateView);
+  setMonospaceFont(ui->pattern);
+  setMonospaceFont(ui->results);
+
+  updateView();
+}
+
+MemorySearchWidget::~MemorySearchWidget() {
+  delete ui;
+}
+
+void MemorySearchWidget::updateOnFrame() {
+  if (ui->everyFrame->isChecked()) narrow();
+}
+
+SearchSize MemorySearchWidget::searchSize() const {
+  return static_cast<SearchSize>(ui->size->currentIndex());
+}
+
+void MemorySearchWidget::updateView() {
+  ui->count->setText(tr("%1 candidates").arg(search.count()));
+  ui->results->clear();
+  for (const auto addr : search.addresses(ListedCandidates)) {
+    const auto value = search.value(addr, searchSize());
+    const auto formattedValue = searchSize() == SearchSize::Byte ? formatHexByte(static_cast<uint8_t>(value)) : formatHexWord(value);
+    ui->results->addItem(formatHexWord(addr).toUpper() + " " + formattedValue.toUpper());
+  }
+}
+
+void MemorySearchWidget::start() {
+  search.start(memory);
+  updateView();
+}
+
+void MemorySearchWidget::find() {
+  const auto pattern = parsePattern(ui->pattern->text());
+  if (!pattern) {
+    emit operationCompleted(tr("invalid search pattern"), false);
+    return;
+  }
+  search.start(memory);
+  search.narrow(memory, *pattern);
+  updateView();
+}
+
+void MemorySearchWidget::narrow() {
+  search.narrow(memory, static_cast<SearchCondition>(ui->condition->currentIndex()), searchSize(), ui->operand->value());
+  updateView();
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include "memory.h"
+#include "memorysearch.h"
+#include <QDockWidget>
+
+namespace Ui {
+class MemorySearchWidget;
+}
+
+class MemorySearchWidget : public QDockWidget {
+  Q_OBJECT
+
+public:
+  static constexpr size_t ListedCandidates = 100;
+
+  explicit MemorySearchWidget(QWidget* parent, const Memory&);
+  ~MemorySearchWidget() override;
+
+signals:
+  void operationCompleted(const QString& message, bool success = true);
+
+public slots:
+  void updateOnFrame();
+
+private:
+  Ui::MemorySearchWidget* ui;
+  const Memory& memory;
+  MemorySearch search;
+
+  SearchSize searchSize() const;
+  void updateView();
+
+private slots:
+  void start();
+  void find();
+  void narrow();
+};
@@ -10,11 +10,21 @@ MemoryWidget::MemoryWidget(QWidget* parent, const Memory& memory) : QWidget(pare
   ui->setupUi(this);
   connect(ui->loadFromFile, &QAbstractButton::clicked, this, &MemoryWidget::loadFromFile);
   connect(ui->saveToFile, &QAbstractButton::clicked, this, &MemoryWidget::saveToFile);
+  connect(ui->mark, &QAbstractButton::clicked, this, &MemoryWidget::mark);
+  connect(ui->diff, &QAbstractButton::clicked, this, &MemoryWidget::diffRequested);
+  connect(ui->record, &QAbstractButton::clicked, this, &MemoryWidget::recordingRequested);
+  connect(ui->stopInputLog, &QAbstractButton::clicked, this, &MemoryWidget::inputLogStopRequested);
+  connect(ui->saveRecording, &QAbstractButton::clicked, this, &MemoryWidget::saveRecording);
+  connect(ui->replay, &QAbstractButton::clicked, this, &MemoryWidget::replayRecording);
+  connect(ui->historyCapacity, &QAbstractSpinBox::editingFinished, this, &MemoryWidget::changeWriteHistory);
+  connect(ui->writes, &QAbstractButton::clicked, this, &MemoryWidget::findWrites);
   connect(ui->startAddress, QOverload<int>::of(&QSpinBox::valueChanged), this, &MemoryWidget::changeStartAddress);
   connect(ui->endAddress, QOverload<int>::of(&QSpinBox::valueChanged), this, &MemoryWidget::changeEndAddress);
   setMonospaceFont(ui->textView);
   setMonospaceFont(ui->startAddress);
   setMonospaceFont(ui->endAddress);
+  setMonospaceFont(ui->writesView);
+  ui->writesView->hide();
 
   ui->startAddress->setValue(0);
   changeStartAddress(0);
@@ -28,6 +38,46 @@ void MemoryWidget::updateOnChange(AddressRange range) {
   if (addressRange.overlapsWith(range)) updateView();
 }
 
+// snapshots aren't taken, recordings aren't started or stopped and writes aren't looked up while running
+void MemoryWidget::updateState(EmulatorState es) {
+  ui->mark->setEnabled(!es.running());
+  ui->diff->setEnabled(!es.running());
+  ui->record->setEnabled(!es.running());
+  ui->stopInputLog->setEnabled(!es.running() && es.inputLogMode != InputLog::Mode::Off);
+  ui->saveRecording->setEnabled(!es.running());
+  ui->replay->setEnabled(!es.running());
+  ui->historyCapacity->setEnabled(!es.running());
+  ui->writes->setEnabled(!es.running());
+}
+
+// the view moves to the first change when none is in it
+void MemoryWidget::showDiff(const MemoryDiff& memoryDiff) {
+  diff = memoryDiff;
+  const auto& ranges = diff.ranges();
+  if (!ranges.empty() && std::none_of(ranges.begin(), ranges.end(), [&](auto range) { return addressRange.overlapsWith(range); }))
+    ui->startAddress->setValue(ranges.front().first);
+  else
+    updateView();
+}
+
+// the latest write last, as the history lists them
+void MemoryWidget::showWrites(AddressRange range, const std::vector<WriteHistory::Write>& writes) {
+  QString text = tr("writes to $%1-$%2\n      cycle   pc  addr  old new\n")
+                     .arg(formatHexWord(range.first).toUpper())
+                     .arg(formatHexWord(range.last).toUpper());
+  for (const auto& write : writes) {
+    text.append(QString("%1  %2  %3  %4  %5\n")
+                    .arg(write.cycle, 11)
+                    .arg(formatHexWord(write.pc).toUpper())
+                    .arg(formatHexWord(write.address).toUpper())
+                    .arg(formatHexByte(write.oldValue).toUpper(), 3)
+                    .arg(formatHexByte(write.newValue).toUpper(), 3));
+  }
+  ui->writesView->setPlainText(text);
+  ui->writesView->moveCursor(QTextCursor::End);
+  ui->writesView->show();
+}
+
 void MemoryWidget::resizeEvent(QResizeEvent* event) {
   if (event->size() != event->oldSize()) { updateView(); }
 }
@@ -40,8 +90,11 @@ void MemoryWidget::updateView() {
   for (int row = 0; row < rows; row++) {
     html.append("<div>");
     html.append(formatHexWord(addr).toUpper()).append(" <span style='color:lightgreen'>");
-    for (int x = 0; x < (cols - 7) / 3; x++) {
-      html.append(formatHexByte(memory[addr++]).toUpper()).append(" ");
+    for (int x = 0; x < (cols - 7) / 3; x++, addr++) {
+      if (diff.contains(addr))
+        html.append("<span style='color:orange'>").append(formatHexByte(memory[addr]).toUpper()).append("</span> ");
+      else
+        html.append(formatHexByte(memory[addr]).toUpper()).append(" ");
     }
     html.append("</span></div>");
   }
@@ -72,6 +125,33 @@ void MemoryWidget::saveToFile() {
   }
 }
 
+void MemoryWidget::mark() {
+  diff = {};
+  updateView();
+  emit markRequested();
+}
+
+void MemoryWidget::saveRecording() {
+  if (auto fname = QFileDialog::getSaveFileName(this, tr("Save Recorded Inputs")); !fname.isEmpty()) {
+    emit saveRecordingRequested(fname);
+  }
+}
+
+void MemoryWidget::replayRecording() {
+  if (auto fname = QFileDialog::getOpenFileName(this, tr("Open Recorded Inputs")); !fname.isEmpty()) {
+    emit replayRequested(fname);
+  }
+}
+
+// the spin box counts thousands of writes, 0 disables the history
+void MemoryWidget::changeWriteHistory() {
+  emit writeHistoryChangeRequested(ui->historyCapacity->value() * 1024);
+}
+
+void MemoryWidget::findWrites() {
+  emit writesRequested({static_cast<Address>(ui->startAddress->value()), static_cast<Address>(ui->endAddress->value())});
+}
+
 void MemoryWidget::changeStartAddress(Address addr) {
   if (addressRange.first != addr) {
     addressRange.first = addr;
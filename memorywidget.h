@@ -5,6 +5,8 @@
 #include "commondefs.h"
 #include "emulatorstate.h"
 #include "memory.h"
+#include "memorydiff.h"
+#include "writehistory.h"
 #include <QWidget>
 
 namespace Ui {
@@ -23,9 +25,20 @@ signals:
   void memoryContentChanged(AddressRange);
   void loadFromFileRequested(Address start, const QString& fname);
   void saveToFileRequested(AddressRange, const QString& fname);
+  void markRequested();
+  void diffRequested();
+  void recordingRequested();
+  void inputLogStopRequested();
+  void saveRecordingRequested(const QString& fname);
+  void replayRequested(const QString& fname);
+  void writeHistoryChangeRequested(int capacity);
+  void writesRequested(AddressRange);
 
 public slots:
   void updateOnChange(AddressRange);
+  void updateState(EmulatorState);
+  void showDiff(const MemoryDiff&);
+  void showWrites(AddressRange, const std::vector<WriteHistory::Write>&);
 
 protected:
   void resizeEvent(QResizeEvent*) override;
@@ -34,6 +47,7 @@ private:
   Ui::MemoryWidget* ui;
   const Memory& memory;
   AddressRange addressRange = AddressRange::Invalid;
+  MemoryDiff diff;
 
   void updateView();
   int rowsInView() const;
@@ -42,6 +56,11 @@ private:
 private slots:
   void loadFromFile();
   void saveToFile();
+  void mark();
+  void saveRecording();
+  void replayRecording();
+  void changeWriteHistory();
+  void findWrites();
   void changeStartAddress(Address);
   void changeEndAddress(Address);
 };
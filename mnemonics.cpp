@@ -7,4 +7,6 @@ const MnemonicTableType MnemonicTable{
     {CLC, "CLC"}, {CLD, "CLD"}, {CLI, "CLI"}, {CLV, "CLV"}, {SEC, "SEC"}, {SED, "SED"}, {SEI, "SEI"}, {JMP, "JMP"}, {JSR, "JSR"},
     {BRK, "BRK"}, {RTI, "RTI"}, {RTS, "RTS"}, {LDA, "LDA"}, {LDX, "LDX"}, {LDY, "LDY"}, {STA, "STA"}, {STX, "STX"}, {STY, "STY"},
     {TAX, "TAX"}, {TAY, "TAY"}, {TSX, "TSX"}, {TXA, "TXA"}, {TYA, "TYA"}, {TXS, "TXS"}, {PHA, "PHA"}, {PHP, "PHP"}, {PLA, "PLA"},
-    {PLP, "PLP"}, {NOP, "NOP"}, {KIL, "KIL"}};
+    {PLP, "PLP"}, {NOP, "NOP"}, {KIL, "KIL"}, {SLO, "SLO"}, {RLA, "RLA"}, {SRE, "SRE"}, {RRA, "RRA"}, {SAX, "SAX"}, {LAX, "LAX"},
+    {DCP, "DCP"}, {ISC, "ISC"}, {ANC, "ANC"}, {ALR, "ALR"}, {ARR, "ARR"}, {SBX, "SBX"}, {BRA, "BRA"}, {STZ, "STZ"}, {PHX, "PHX"},
+    {PHY, "PHY"}, {PLX, "PLX"}, {PLY, "PLY"}, {TRB, "TRB"}, {TSB, "TSB"}, {HCL, "HCL"}};
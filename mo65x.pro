@@ -22,30 +22,56 @@ SOURCES += \
     centralwidget.cpp \
     config.cpp \
     cpu.cpp \
+    cpuengine.cpp \
+    cpuvariant.cpp \
     cpustate.cpp \
     cpuwidget.cpp \
+    decodecache.cpp \
     disassembler.cpp \
     disassemblerview.cpp \
     disassemblerwidget.cpp \
     screenwidget.cpp \
     emulator.cpp \
+    eventscheduler.cpp \
     executionstatistics.cpp \
     filedatastorage.cpp \
+    hangdetector.cpp \
+    hostservices.cpp \
+    inputlog.cpp \
     main.cpp \
     mainwindow.cpp \
     memory.cpp \
+    memorydiff.cpp \
+    memorysearch.cpp \
+    memorysearchwidget.cpp \
     memorywidget.cpp \
     mnemonics.cpp \
+    nativeroutine.cpp \
+    processorport.cpp \
+    rewindhistory.cpp \
     runlevel.cpp \
+    staticrecompiler.cpp \
     symboltable.cpp \
+    translationcache.cpp \
     videowidget.cpp \
     wordspinbox.cpp \
+    writehistory.cpp \
     test/assemblertest.cpp \
+    test/bustest.cpp \
+    test/cpubenchmark.cpp \
     test/instructionstest.cpp \
-    test/flagstest.cpp
+    test/staticrecompilertest.cpp \
+    test/variantstest.cpp \
+    test/flagstest.cpp \
+    test/hostservicestest.cpp \
+    test/snapshotstest.cpp \
+    test/writehistorytest.cpp \
+    test/memorysearchtest.cpp \
+    test/memorydifftest.cpp
 
 HEADERS += \
     addressrange.h \
+    alutable.h \
     assembler.h \
     assemblerwidget.h \
     assemblyresult.h \
@@ -58,9 +84,14 @@ HEADERS += \
     cpuinfo.h \
     cpustate.h \
     cpuwidget.h \
+    decodecache.h \
     decodetable.h \
     bytespinbox.h \
+    buspolicy.h \
     cpu.h \
+    cpucore.h \
+    cpuengine.h \
+    cpuvariant.h \
     disassembler.h \
     disassemblerview.h \
     disassemblerwidget.h \
@@ -68,28 +99,54 @@ HEADERS += \
     screenwidget.h \
     emulator.h \
     emulatorstate.h \
+    eventscheduler.h \
     executionstatistics.h \
     filedatastorage.h \
+    fusedhandlers.h \
+    hangdetector.h \
+    hostservices.h \
+    inputlog.h \
     instruction.h \
     instructiontable.h \
     instructiontype.h \
     mainwindow.h \
     memory.h \
+    memorydiff.h \
+    memorysearch.h \
+    memorysearchwidget.h \
     memorywidget.h \
     mnemonics.h \
+    nativeroutine.h \
     operandptr.h \
     operandsformat.h \
+    processorport.h \
     processorstatus.h \
+    recompiledcode.h \
     registers.h \
+    rewindhistory.h \
     runlevel.h \
+    snapshot.h \
     stackpointer.h \
+    staticrecompiler.h \
     symboltable.h \
+    translationcache.h \
     uitools.h \
     videowidget.h \
     wordspinbox.h \
+    writehistory.h \
     test/assemblertest.h \
+    test/bustest.h \
+    test/cpubenchmark.h \
+    test/cpuenginerows.h \
     test/instructionstest.h \
-    test/flagstest.h
+    test/staticrecompilertest.h \
+    test/variantstest.h \
+    test/flagstest.h \
+    test/hostservicestest.h \
+    test/snapshotstest.h \
+    test/writehistorytest.h \
+    test/memorysearchtest.h \
+    test/memorydifftest.h
 
 FORMS += \
     assemblerwidget.ui \
@@ -98,6 +155,7 @@ FORMS += \
     disassemblerview.ui \
     disassemblerwidget.ui \
     mainwindow.ui \
+    memorysearchwidget.ui \
     memorywidget.ui \
     videowidget.ui
 
@@ -112,7 +170,14 @@ test {
   TARGET = $${TARGET}_tests
 
   SOURCES -= main.cpp
-  SOURCES += test/main.cpp
+  SOURCES += test/main.cpp test/recompiledroutine.cpp
+}
+
+recompiler {
+  TARGET = $${TARGET}_recompiler
+
+  SOURCES -= main.cpp
+  SOURCES += recompiler/main.cpp
 }
 
 message($${TARGET})
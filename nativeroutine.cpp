@@ -0,0 +1,95 @@
+#include "nativeroutine.h"
+#include "memory.h"
+
+const char* formatNativeRoutineType(NativeRoutineType type) {
+  switch (type) {
+  case NativeRoutineType::Copy: return "copy";
+  case NativeRoutineType::Fill: return "fill";
+  case NativeRoutineType::Clear: return "clear";
+  }
+  return nullptr;
+}
+
+NativeRoutineType NativeRoutine::type(uint8_t a) const {
+  if (transfers.front().sourceMode != ImpliedOrAccumulator) return NativeRoutineType::Copy;
+  return a ? NativeRoutineType::Fill : NativeRoutineType::Clear;
+}
+
+static bool indexedBy(OperandsFormat mode, bool indexY) {
+  return indexY ? mode == AbsoluteY || mode == IndirectIndexedY : mode == AbsoluteX;
+}
+
+std::unique_ptr<NativeRoutine> recogniseNativeRoutine(const Memory& memory, AddressRange code,
+                                                      const Instruction* instructions) {
+  struct Decoded {
+    Instruction ins;
+    uint16_t operand;
+  };
+
+  std::vector<Decoded> decoded;
+  for (int pc = code.first; pc <= code.last;) {
+    const auto& ins = instructions[memory[static_cast<Address>(pc)]];
+    uint16_t operand = 0;
+    if (ins.size == 2) operand = memory[static_cast<Address>(pc + 1)];
+    if (ins.size == 3) operand = memory.word(static_cast<Address>(pc + 1));
+    decoded.push_back({ins, operand});
+    pc += ins.size;
+  }
+
+  // BNE back to the start preceded by index step and optional compare
+  if (decoded.size() < 3) return nullptr;
+  const auto branch = decoded.end() - 1;
+  const auto next = static_cast<Address>(code.last + 1);
+  if (branch->ins.type != BNE || static_cast<Address>(next + static_cast<int8_t>(branch->operand)) != code.first)
+    return nullptr;
+
+  auto routine = std::make_unique<NativeRoutine>();
+  routine->code = code;
+  auto step = branch - 1;
+  if (step->ins.type == CPX || step->ins.type == CPY) {
+    if (step->ins.mode != Immediate) return nullptr;
+    routine->compare = true;
+    routine->limit = static_cast<uint8_t>(step->operand);
+    routine->indexY = step->ins.type == CPY;
+    step--;
+  } else {
+    routine->compare = false;
+    routine->limit = 0;
+    routine->indexY = step->ins.type == INY || step->ins.type == DEY;
+  }
+  switch (step->ins.type) {
+  case INX:
+  case DEX:
+    if (routine->indexY) return nullptr;
+    break;
+  case INY:
+  case DEY:
+    if (!routine->indexY) return nullptr;
+    break;
+  default: return nullptr;
+  }
+  routine->increment = step->ins.type == INX || step->ins.type == INY;
+
+  // loads of A each followed by stores of it, a loop with loads has to start with one
+  const Decoded* load = nullptr;
+  bool stored = true;
+  for (auto it = decoded.begin(); it != step; it++) {
+    if (!indexedBy(it->ins.mode, routine->indexY)) return nullptr;
+    if (it->ins.type == LDA && stored) {
+      load = &*it;
+      stored = false;
+    } else if (it->ins.type == STA) {
+      routine->transfers.push_back({load ? load->ins.mode : ImpliedOrAccumulator, load ? load->operand : uint16_t(0),
+                                    it->ins.mode, it->operand, load && !stored});
+      stored = true;
+    } else {
+      return nullptr;
+    }
+  }
+  if (!stored || routine->transfers.empty() || (load && decoded.front().ins.type != LDA)) return nullptr;
+
+  routine->branchTakenCycles = (next ^ code.first) & 0xff00 ? 2 : 1;
+  routine->iterationCycles = routine->branchTakenCycles;
+  for (const auto& d : decoded) routine->iterationCycles += d.ins.cycles;
+  return routine;
+}
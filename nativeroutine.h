@@ -0,0 +1,48 @@
+#pragma once
+
+#include "addressrange.h"
+#include "instruction.h"
+#include <memory>
+#include <vector>
+
+class Memory;
+
+enum class NativeRoutineType : uint8_t { Copy, Fill, Clear };
+
+const char* formatNativeRoutineType(NativeRoutineType);
+
+// Counted loop which only copies or fills memory through an index register, e.g.
+//   loop: LDA $0521,X / STA $0520,X / INX / CPX #31 / BNE loop
+// Every store is one transfer, from the location loaded before it or of A when there is no load in the loop. The
+// whole loop can then run as one memmove or memset per transfer.
+struct NativeRoutine {
+  struct Transfer {
+    OperandsFormat sourceMode; // ImpliedOrAccumulator for stores of A
+    uint16_t source;
+    OperandsFormat destinationMode;
+    uint16_t destination;
+    bool load; // first store after the load, pays its page crossing
+  };
+
+  AddressRange code;
+  bool indexY;
+  bool increment;
+  bool compare; // index compared to limit, otherwise the loop ends when it reaches zero
+  uint8_t limit;
+  std::vector<Transfer> transfers;
+  long iterationCycles; // taken branch included, page crossing of loads not
+  long branchTakenCycles;
+
+  NativeRoutineType type(uint8_t a) const;
+};
+
+// Replaced routine as reported by Cpu::replacedRoutines()
+struct NativeRoutineUse {
+  AddressRange code;
+  NativeRoutineType type;
+  long runs;
+  long bytes;
+  long cycles;
+};
+
+std::unique_ptr<NativeRoutine> recogniseNativeRoutine(const Memory&, AddressRange code, const Instruction* instructions);
@@ -15,6 +15,7 @@ enum OperandsFormat {
   ZeroPageY,
   IndexedIndirectX,
   IndirectIndexedY,
+  ZeroPageIndirect,
 
   // 16-bit operand
 
@@ -22,4 +23,5 @@ enum OperandsFormat {
   Absolute,
   AbsoluteX,
   AbsoluteY,
+  AbsoluteIndexedIndirect,
 };
@@ -0,0 +1,106 @@
+#include "processorport.h"
+#include "cpudefs.h"
+#include <algorithm>
+
+static constexpr uint8_t LoRam = 0x01;
+static constexpr uint8_t HiRam = 0x02;
+static constexpr uint8_t CharEn = 0x04;
+
+static uint8_t page(Address addr) {
+  return static_cast<uint8_t>(addr >> 8);
+}
+
+ProcessorPort::ProcessorPort(Memory& memory, CodeChangeHandler codeChanged)
+    : memory(memory), codeChanged(std::move(codeChanged)) {
+  areas[Basic].range = {0xa000, 0xbfff};
+  areas[Character].range = {0xd000, 0xdfff};
+  areas[Kernal].range = {0xe000, 0xffff};
+}
+
+void ProcessorPort::enable(bool enabled) {
+  if (enabled == enabledPort) return;
+  enabledPort = enabled;
+  if (enabled) {
+    memory.mapPort([this](Address addr, uint8_t value) { writePort(addr, value); });
+    reset();
+  } else {
+    for (const auto bank : {Basic, Character, Kernal}) show(bank, Ram);
+    memory.mapPort({});
+  }
+}
+
+void ProcessorPort::reset() {
+  ddr = ResetDirection;
+  output = ResetData;
+  update();
+}
+
+void ProcessorPort::restore(State saved) {
+  enable(saved.enabled);
+  ddr = saved.direction;
+  output = saved.data;
+  update();
+}
+
+void ProcessorPort::loadRom(Bank bank, const Data& rom) {
+  auto& area = areas[bank];
+  show(bank, Ram);
+  area.rom.clear();
+  if (!rom.empty()) {
+    area.rom.resize(area.range.size());
+    std::copy_n(rom.begin(), std::min(rom.size(), area.rom.size()), area.rom.begin());
+  }
+  update();
+}
+
+void ProcessorPort::mapIo(Memory::ReadHandler read, Memory::WriteHandler write) {
+  show(Character, Ram);
+  ioRead = std::move(read);
+  ioWrite = std::move(write);
+  update();
+}
+
+void ProcessorPort::writePort(Address addr, uint8_t value) {
+  if (addr == CpuAddress::IoPortConfig)
+    ddr = value;
+  else
+    output = value;
+  update();
+}
+
+void ProcessorPort::update() {
+  if (!enabledPort) return;
+  memory[CpuAddress::IoPortConfig] = ddr;
+  memory[CpuAddress::IoPortData] = lines();
+  memory.touch({CpuAddress::IoPortConfig, CpuAddress::IoPortData});
+  for (const auto bank : {Basic, Character, Kernal}) show(bank, wanted(bank));
+}
+
+ProcessorPort::Content ProcessorPort::wanted(Bank bank) const {
+  const auto config = lines();
+  const bool rom = !areas[bank].rom.empty();
+  switch (bank) {
+  case Basic: return rom && (config & (LoRam | HiRam)) == (LoRam | HiRam) ? Rom : Ram;
+  case Kernal: return rom && (config & HiRam) ? Rom : Ram;
+  case Character:
+    if (!(config & (LoRam | HiRam))) return Ram;
+    if (config & CharEn) return ioRead || ioWrite ? Io : Ram;
+    return rom ? Rom : Ram;
+  }
+  return Ram;
+}
+
+// Maps the wanted contents to the bank, code there changes unless both are RAM
+void ProcessorPort::show(Bank bank, Content content) {
+  auto& area = areas[bank];
+  if (area.content == content) return;
+  const auto firstPage = page(area.range.first);
+  const auto lastPage = page(area.range.last);
+  switch (content) {
+  case Ram: memory.unmapDevice(firstPage, lastPage); break;
+  case Rom: memory.mapBank(firstPage, lastPage, area.rom.data()); break;
+  case Io: memory.mapDevice(firstPage, lastPage, ioRead, ioWrite); break;
+  }
+  area.content = content;
+  codeChanged(area.range);
+}
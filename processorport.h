@@ -0,0 +1,67 @@
+#pragma once
+
+#include "addressrange.h"
+#include "commondefs.h"
+#include "memory.h"
+#include <array>
+#include <functional>
+
+using CodeChangeHandler = std::function<void(AddressRange)>;
+
+// On-chip I/O port of the 6510 at $00 (data direction) and $01 (data), lines 0-2 switch BASIC ROM ($A000-$BFFF),
+// KERNAL ROM ($E000-$FFFF) and I/O or character ROM ($D000-$DFFF) in and out as the C64 does. Lines set as inputs
+// read as high, bits 6 and 7 have no lines and read as low. ROM images are memory banks, visible ROM is read from the
+// image and writes go to the RAM under it, which stays in the memory array. A bank switch only remaps the pages of the
+// banks which change. Banks without ROM loaded stay RAM, an empty image unloads it.
+class ProcessorPort {
+public:
+  enum Bank { Basic, Character, Kernal };
+
+  static constexpr uint8_t ResetDirection = 0x2f;
+  static constexpr uint8_t ResetData = 0x37;
+  static constexpr uint8_t LineMask = 0x3f;
+
+  // what snapshots keep to map the banks again
+  struct State {
+    bool enabled = false;
+    uint8_t direction = ResetDirection;
+    uint8_t data = ResetData;
+  };
+
+  ProcessorPort(Memory&, CodeChangeHandler);
+
+  bool enabled() const { return enabledPort; }
+  void enable(bool);
+  void reset();
+  void loadRom(Bank, const Data&);
+  void mapIo(Memory::ReadHandler, Memory::WriteHandler);
+  uint8_t direction() const { return ddr; }
+  uint8_t data() const { return output; }
+  uint8_t lines() const { return (output & ddr) | (~ddr & LineMask); }
+  uint8_t hiddenRam(Address addr) const { return memory.cbegin()[addr]; }
+  State state() const { return {enabledPort, ddr, output}; }
+  void restore(State);
+
+private:
+  enum Content { Ram, Rom, Io };
+
+  struct Area {
+    AddressRange range;
+    Data rom;
+    Content content = Ram; // visible now
+  };
+
+  Memory& memory;
+  CodeChangeHandler codeChanged;
+  std::array<Area, 3> areas;
+  Memory::ReadHandler ioRead;
+  Memory::WriteHandler ioWrite;
+  bool enabledPort = false;
+  uint8_t ddr = ResetDirection;
+  uint8_t output = ResetData;
+
+  void writePort(Address, uint8_t);
+  void update();
+  Content wanted(Bank) const;
+  void show(Bank, Content);
+};
@@ -1,7 +1,32 @@
 #pragma once
 
+#include <array>
 #include <cstdint>
 
+// N and Z bits of P for every result byte
+constexpr std::array<uint8_t, 256> NZFlagsTable = [] {
+  std::array<uint8_t, 256> tab{};
+  for (unsigned result = 0; result < tab.size(); result++)
+    tab[result] = static_cast<uint8_t>((result & 0x80) | (result ? 0 : 0x02));
+  return tab;
+}();
+
+// Single status bit stored inside the packed byte. Every flag shares the byte through the union in ProcessorStatus,
+// so reading or writing a flag only touches its own bit.
+template <uint8_t Mask>
+struct StatusFlag {
+  uint8_t bits;
+
+  operator bool() const { return bits & Mask; }
+
+  StatusFlag& operator=(bool value) {
+    bits = value ? bits | Mask : bits & static_cast<uint8_t>(~Mask);
+    return *this;
+  }
+
+  StatusFlag& operator=(const StatusFlag& flag) { return *this = static_cast<bool>(flag); }
+};
+
 struct ProcessorStatus {
   static constexpr uint8_t NegativeBitMask = 0x80;
   static constexpr uint8_t OverflowBitMask = 0x40;
@@ -10,13 +35,39 @@ struct ProcessorStatus {
   static constexpr uint8_t InterruptBitMask = 0x04;
   static constexpr uint8_t ZeroBitMask = 0x02;
   static constexpr uint8_t CarryBitMask = 0x01;
+  static constexpr uint8_t FlagsMask =
+      NegativeBitMask | OverflowBitMask | DecimalBitMask | InterruptBitMask | ZeroBitMask | CarryBitMask;
+
+  struct PackedByte {
+    uint8_t bits;
+  };
+
+  // P is kept as the byte pushed on the stack, flags are views of it
+  union {
+    PackedByte packed{};
+    StatusFlag<NegativeBitMask> negative;
+    StatusFlag<OverflowBitMask> overflow;
+    StatusFlag<DecimalBitMask> decimal;
+    StatusFlag<InterruptBitMask> interrupt;
+    StatusFlag<ZeroBitMask> zero;
+    StatusFlag<CarryBitMask> carry;
+  };
 
-  bool negative;
-  bool overflow;
-  bool decimal;
-  bool interrupt;
-  bool zero;
-  bool carry;
+  // While instructions are executed N and Z are evaluated lazily, handlers only store the result and flags are worked
+  // out from it when they are needed. Both sources are kept so every combination of N and Z can be represented.
+  uint8_t negativeSource = 0;
+  uint8_t zeroSource = 1;
+
+  ProcessorStatus() = default;
+  ProcessorStatus(const ProcessorStatus& other)
+      : packed(other.packed), negativeSource(other.negativeSource), zeroSource(other.zeroSource) {}
+
+  ProcessorStatus& operator=(const ProcessorStatus& other) {
+    packed = other.packed;
+    negativeSource = other.negativeSource;
+    zeroSource = other.zeroSource;
+    return *this;
+  }
 
   void computeN(uint16_t result) { negative = result & 0x80; }
   void computeZ(uint16_t result) { zero = !(result & 0xff); }
@@ -24,8 +75,7 @@ struct ProcessorStatus {
   void computeV(uint16_t op1, uint16_t op2, uint16_t result) { overflow = (op1 ^ result) & (op2 ^ result) & 0x80; }
 
   void computeNZ(uint16_t result) {
-    computeN(result);
-    computeZ(result);
+    packed.bits = (packed.bits & ~(NegativeBitMask | ZeroBitMask)) | NZFlagsTable[result & 0xff];
   }
 
   void computeNZC(uint16_t result) {
@@ -33,20 +83,39 @@ struct ProcessorStatus {
     computeC(result);
   }
 
-  void operator=(uint8_t v) {
-    this->negative = v & NegativeBitMask;
-    this->overflow = v & OverflowBitMask;
-    this->decimal = v & DecimalBitMask;
-    this->interrupt = v & InterruptBitMask;
-    this->zero = v & ZeroBitMask;
-    this->carry = v & CarryBitMask;
+  void deferNZ(uint16_t result) { negativeSource = zeroSource = static_cast<uint8_t>(result); }
+
+  void deferNZC(uint16_t result) {
+    deferNZ(result);
+    computeC(result);
+  }
+
+  void deferN(uint8_t result) { negativeSource = result; }
+  void deferZ(uint8_t result) { zeroSource = result; }
+  bool deferredNegative() const { return negativeSource & 0x80; }
+  bool deferredZero() const { return !zeroSource; }
+
+  void deferCurrentNZ() {
+    negativeSource = packed.bits & NegativeBitMask;
+    zeroSource = ~packed.bits & ZeroBitMask;
   }
 
-  operator uint8_t() const {
-    return (negative ? NegativeBitMask : 0) | (overflow ? OverflowBitMask : 0) | (decimal ? DecimalBitMask : 0) |
-           (interrupt ? InterruptBitMask : 0) | (zero ? ZeroBitMask : 0) | (carry ? CarryBitMask : 0);
+  void resolveNZ() {
+    packed.bits = (packed.bits & ~(NegativeBitMask | ZeroBitMask)) | (NZFlagsTable[negativeSource] & NegativeBitMask) |
+                  (NZFlagsTable[zeroSource] & ZeroBitMask);
   }
 
+  void operator=(uint8_t v) {
+    packed.bits = v & FlagsMask;
+    deferCurrentNZ();
+  }
+
+  operator uint8_t() const { return packed.bits; }
+
   void fromByte(uint8_t b) { *this = b; }
   uint8_t toByte() const { return *this; }
 };
+
+static_assert(sizeof(ProcessorStatus) == 3, "P is expected to take one packed byte plus the two lazy flag sources");
+static_assert(NZFlagsTable[0] == ProcessorStatus::ZeroBitMask && NZFlagsTable[0x80] == ProcessorStatus::NegativeBitMask,
+              "NZ table must use the P bit layout");
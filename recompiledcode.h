@@ -0,0 +1,34 @@
+#pragma once
+
+#include "fusedhandlers.h"
+
+// Run time support of C++ source generated by StaticRecompiler. The generated source defines entry(), load() and
+// runBlock(), addresses without recompiled block run on the interpreter one instruction at a time.
+
+class RecompiledCode {
+public:
+  static Address entry();
+  static void load(Memory&);
+
+  static void run(Cpu& cpu) {
+    cpu.regs.p.deferCurrentNZ();
+    cpu.state = CpuState::Running;
+    while (cpu.state == CpuState::Running) {
+      if (!runBlock(cpu)) cpu.stepThreaded<CpuVariant::Nmos>();
+      cpu.eventScheduler.dispatch(cpu.cycles);
+      if (cpu.runLevel != CpuRunLevel::Normal) cpu.handleRunLevel();
+    }
+    cpu.regs.p.resolveNZ();
+    if (cpu.state == CpuState::Stopping) cpu.state = CpuState::Stopped;
+  }
+
+  template <InstructionType Type, OperandsFormat Mode>
+  static void exec(Cpu& cpu, uint16_t operand) {
+    cpu.execInstruction<Type, Mode>(operand);
+  }
+
+  static void addCycles(Cpu& cpu, long cycles) { cpu.cycles += cycles; }
+
+private:
+  static bool runBlock(Cpu&);
+};
@@ -0,0 +1,106 @@
+#include "assembler.h"
+#include "emulator.h"
+#include "staticrecompiler.h"
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QFile>
+#include <QFileInfo>
+#include <QTextStream>
+#include <optional>
+
+// Command line tool writing C++ source of the program given as assembler source (.asm) or binary image.
+//
+//   mo65x_recompiler [--origin ADDR] [--entry ADDR]... [--output FILE] INPUT
+
+static std::optional<Address> parseAddress(const QString& str) {
+  bool ok = false;
+  const auto value = QString(str).remove('$').toUInt(&ok, 16);
+  if (ok && value < Memory::Size) return static_cast<Address>(value);
+  return std::nullopt;
+}
+
+static std::optional<QString> assembleFile(const QString& fname, Assembler& assembler) {
+  QFile file(fname);
+  if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) return QString("unable to read file %1").arg(fname);
+  QString src = file.readAll();
+
+  const auto process = [&]() -> std::optional<QString> {
+    QTextStream is(&src, QIODevice::ReadOnly);
+    for (int lineNum = 1; !is.atEnd(); lineNum++) {
+      if (auto result = assembler.processLine(is.readLine()); result != AssemblyResult::Ok)
+        return QString("%1 at line %2").arg(formatAssemblyResult(result)).arg(lineNum);
+    }
+    return std::nullopt;
+  };
+
+  assembler.init();
+  assembler.changeMode(Assembler::ProcessingMode::ScanForSymbols);
+  if (auto error = process()) return error;
+  assembler.initPreserveSymbols();
+  assembler.changeMode(Assembler::ProcessingMode::EmitCode);
+  return process();
+}
+
+int main(int argc, char** argv) {
+  QCoreApplication app(argc, argv);
+  QTextStream err(stderr);
+
+  QCommandLineParser parser;
+  parser.setApplicationDescription("Translates 6502 program into C++ source, one function per basic block.");
+  parser.addHelpOption();
+  parser.addPositionalArgument("input", "assembler source (.asm) or binary image");
+  parser.addOption({{"o", "output"}, "output C++ file, input name with .cpp suffix by default", "file"});
+  parser.addOption({"origin", "load address of binary image", "address", "0600"});
+  parser.addOption({{"e", "entry"}, "entry point, start of the image by default, can be repeated", "address"});
+  parser.process(app);
+
+  if (parser.positionalArguments().size() != 1) parser.showHelp(1);
+  const auto input = parser.positionalArguments().front();
+
+  Emulator emulator;
+  AddressRange image;
+  if (QFileInfo(input).suffix().toLower() == "asm") {
+    Assembler assembler(emulator.memoryRef());
+    if (auto error = assembleFile(input, assembler)) {
+      err << *error << "\n";
+      return 1;
+    }
+    image = assembler.affectedAddressRange();
+  } else {
+    const auto origin = parseAddress(parser.value("origin"));
+    if (!origin) {
+      err << "invalid origin " << parser.value("origin") << "\n";
+      return 1;
+    }
+    QObject::connect(&emulator, &Emulator::memoryContentChanged, [&](AddressRange range) { image = range; });
+    emulator.loadMemoryFromFile(*origin, input);
+  }
+  if (!image.valid()) {
+    err << "nothing to recompile in " << input << "\n";
+    return 1;
+  }
+
+  StaticRecompiler recompiler(emulator.memoryView(), image);
+  for (const auto& str : parser.values("entry")) {
+    const auto entry = parseAddress(str);
+    if (!entry) {
+      err << "invalid entry point " << str << "\n";
+      return 1;
+    }
+    recompiler.addEntryPoint(*entry);
+  }
+  if (parser.values("entry").isEmpty()) recompiler.addEntryPoint(image.first);
+  recompiler.analyze();
+
+  const auto output = parser.isSet("output") ? parser.value("output")
+                                              : QFileInfo(input).path() + "/" + QFileInfo(input).completeBaseName() + ".cpp";
+  QFile file(output);
+  if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
+    err << "unable to write file " << output << "\n";
+    return 1;
+  }
+  file.write(recompiler.generate().toUtf8());
+  err << recompiler.blocks().size() << " blocks of range $" << QString::number(image.first, 16) << "-$"
+      << QString::number(image.last, 16) << " written to " << output << "\n";
+  return 0;
+}
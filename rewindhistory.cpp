@@ -0,0 +1,52 @@
+#include "rewindhistory.h"
+#include "eventscheduler.h"
+#include <algorithm>
+
+void RewindHistory::changeInterval(long cycles) {
+  baseInterval = std::max(0L, cycles);
+  clear();
+}
+
+long RewindHistory::nextCheckpoint() const {
+  if (!enabled()) return EventScheduler::Never;
+  return savedCheckpoints.empty() ? 0 : savedCheckpoints.back().cycles + currentInterval;
+}
+
+// A checkpoint has to come before the interrupts of its cycle, it is left to the next instruction otherwise
+void RewindHistory::addCheckpoint(Snapshot snapshot) {
+  if (!interrupts.empty() && interrupts.back().cycle >= snapshot.cycles) return;
+  if (savedCheckpoints.size() == MaxCheckpoints) {
+    std::deque<Snapshot> thinned;
+    for (size_t i = 0; i < savedCheckpoints.size(); i += 2) thinned.push_back(std::move(savedCheckpoints[i]));
+    savedCheckpoints = std::move(thinned);
+    currentInterval *= 2;
+  }
+  savedCheckpoints.push_back(std::move(snapshot));
+}
+
+void RewindHistory::addInterrupt(long cycle, CpuRunLevel runLevel) {
+  if (enabled()) interrupts.push_back({cycle, runLevel});
+}
+
+void RewindHistory::clear() {
+  currentInterval = baseInterval;
+  savedCheckpoints.clear();
+  interrupts.clear();
+}
+
+const Snapshot* RewindHistory::checkpointBefore(long cycle) const {
+  const auto it = std::find_if(savedCheckpoints.rbegin(), savedCheckpoints.rend(),
+                               [cycle](const Snapshot& checkpoint) { return checkpoint.cycles < cycle; });
+  return it == savedCheckpoints.rend() ? nullptr : &*it;
+}
+
+std::vector<RewindHistory::Interrupt>::const_iterator RewindHistory::interruptsFrom(long cycle) const {
+  return std::lower_bound(interrupts.cbegin(), interrupts.cend(), cycle,
+                          [](const Interrupt& interrupt, long cycle) { return interrupt.cycle < cycle; });
+}
+
+// Drops what comes after the cycle, the run goes on from there in another way
+void RewindHistory::truncate(long cycle) {
+  while (!savedCheckpoints.empty() && savedCheckpoints.back().cycles > cycle) savedCheckpoints.pop_back();
+  interrupts.erase(interruptsFrom(cycle), interrupts.end());
+}
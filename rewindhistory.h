@@ -0,0 +1,40 @@
+#pragma once
+
+#include "runlevel.h"
+#include "snapshot.h"
+#include <deque>
+#include <vector>
+
+// Checkpoints taken every interval cycles during a run and the interrupts taken in it, from the nearest checkpoint the
+// run can be executed again up to any earlier instruction. When the checkpoints reach their maximum number every
+// second one is dropped and the interval doubles, so any instruction of a run of any length is at most the current
+// interval of cycles away from a checkpoint.
+class RewindHistory {
+public:
+  static constexpr size_t MaxCheckpoints = 1024;
+
+  struct Interrupt {
+    long cycle;
+    CpuRunLevel runLevel;
+  };
+
+  bool enabled() const { return baseInterval > 0; }
+  long interval() const { return currentInterval; }
+  void changeInterval(long cycles);
+  long nextCheckpoint() const;
+  void addCheckpoint(Snapshot);
+  void addInterrupt(long cycle, CpuRunLevel);
+  void clear();
+
+  const std::deque<Snapshot>& checkpoints() const { return savedCheckpoints; }
+  const Snapshot* checkpointBefore(long cycle) const;
+  std::vector<Interrupt>::const_iterator interruptsFrom(long cycle) const;
+  std::vector<Interrupt>::const_iterator interruptsEnd() const { return interrupts.cend(); }
+  void truncate(long cycle);
+
+private:
+  long baseInterval = 0;
+  long currentInterval = 0;
+  std::deque<Snapshot> savedCheckpoints;
+  std::vector<Interrupt> interrupts;
+};
@@ -0,0 +1,27 @@
+#pragma once
+
+#include "cpustate.h"
+#include "memory.h"
+#include "processorport.h"
+#include "registers.h"
+#include "runlevel.h"
+#include <array>
+#include <memory>
+
+// Machine state taken by Cpu::takeSnapshot(): registers, execution state, cycle count, RAM and the processor port.
+// Memory is kept as shared read-only pages, a page not written between two snapshots is the same object in both, so a
+// snapshot costs the page table plus the pages written since the previous one. Pages hold RAM also where ROM hides it,
+// the port state maps the banks again on restore. Pending events and devices aren't part of it.
+struct Snapshot {
+  using Page = std::array<uint8_t, Memory::PageSize>;
+  using PageTable = std::array<std::shared_ptr<const Page>, Memory::NumberOfPages>;
+
+  Registers regs;
+  CpuState state = CpuState::Idle;
+  CpuRunLevel runLevel = CpuRunLevel::Normal;
+  long cycles = 0;
+  PageTable pages;
+  ProcessorPort::State port;
+
+  uint8_t operator[](Address addr) const { return (*pages[addr >> 8])[addr & 0xff]; }
+};
@@ -0,0 +1,209 @@
+#include "staticrecompiler.h"
+#include "commonformatters.h"
+#include "disassembler.h"
+#include "instructiontable.h"
+#include "mnemonics.h"
+#include <QTextStream>
+#include <algorithm>
+#include <deque>
+
+static const std::map<OperandsFormat, const char*> OperandsFormatNames{
+    {ImpliedOrAccumulator, "ImpliedOrAccumulator"},
+    {Branch, "Branch"},
+    {Immediate, "Immediate"},
+    {ZeroPage, "ZeroPage"},
+    {ZeroPageX, "ZeroPageX"},
+    {ZeroPageY, "ZeroPageY"},
+    {IndexedIndirectX, "IndexedIndirectX"},
+    {IndirectIndexedY, "IndirectIndexedY"},
+    {ZeroPageIndirect, "ZeroPageIndirect"},
+    {Indirect, "Indirect"},
+    {Absolute, "Absolute"},
+    {AbsoluteX, "AbsoluteX"},
+    {AbsoluteY, "AbsoluteY"},
+    {AbsoluteIndexedIndirect, "AbsoluteIndexedIndirect"}};
+
+static bool endsBlock(InstructionType type) {
+  switch (type) {
+  case BCC:
+  case BCS:
+  case BEQ:
+  case BMI:
+  case BNE:
+  case BPL:
+  case BVC:
+  case BVS:
+  case JMP:
+  case JSR:
+  case RTS:
+  case RTI:
+  case BRK:
+  case KIL:
+  case HCL: return true;
+  default: return false;
+  }
+}
+
+static QString hexLiteral(uint16_t value) {
+  return "0x" + formatHexWord(value);
+}
+
+StaticRecompiler::StaticRecompiler(const Memory& memory, AddressRange image) : memory(memory), image(image) {
+}
+
+void StaticRecompiler::addEntryPoint(Address addr) {
+  entryPoints.push_back(addr);
+}
+
+bool StaticRecompiler::fitsInImage(Address addr) const {
+  return image.contains(addr) && addr + InstructionTable[memory[addr]].size - 1 <= image.last;
+}
+
+void StaticRecompiler::findLeaders() {
+  std::set<Address> visited;
+  std::deque<Address> pending(entryPoints.begin(), entryPoints.end());
+  leaders.insert(entryPoints.begin(), entryPoints.end());
+
+  const auto follow = [&](int addr) {
+    if (addr < 0 || addr >= static_cast<int>(Memory::Size)) return;
+    leaders.insert(static_cast<Address>(addr));
+    pending.push_back(static_cast<Address>(addr));
+  };
+
+  while (!pending.empty()) {
+    Address addr = pending.front();
+    pending.pop_front();
+    while (fitsInImage(addr) && visited.insert(addr).second) {
+      const auto& ins = InstructionTable[memory[addr]];
+      const int next = addr + ins.size;
+      if (ins.mode == Branch) {
+        follow(next + static_cast<int8_t>(memory[static_cast<Address>(addr + 1)]));
+        follow(next);
+      } else if (ins.type == JSR) {
+        follow(memory.word(static_cast<Address>(addr + 1)));
+        follow(next);
+      } else if (ins.type == JMP && ins.mode == Absolute) {
+        follow(memory.word(static_cast<Address>(addr + 1)));
+      }
+      if (endsBlock(ins.type) || next >= static_cast<int>(Memory::Size)) break;
+      addr = static_cast<Address>(next);
+    }
+  }
+}
+
+StaticRecompiler::Block StaticRecompiler::collectBlock(Address first) const {
+  Block block;
+  for (Address addr = first; fitsInImage(addr);) {
+    const auto& ins = InstructionTable[memory[addr]];
+    block.instructions.push_back(addr);
+    block.range.expand(addr);
+    block.range.expand(static_cast<Address>(addr + ins.size - 1));
+    const int next = addr + ins.size;
+    if (endsBlock(ins.type) || next >= static_cast<int>(Memory::Size) || leaders.count(static_cast<Address>(next))) break;
+    addr = static_cast<Address>(next);
+  }
+  return block;
+}
+
+// addresses the recompiled instructions may store to, as far as they are known before running
+std::vector<AddressRange> StaticRecompiler::storeTargets() const {
+  std::vector<AddressRange> targets;
+  for (const auto& [first, block] : basicBlocks) {
+    for (const auto addr : block.instructions) {
+      const auto& ins = InstructionTable[memory[addr]];
+      if (!writesOperand(ins)) continue;
+      const auto next = static_cast<Address>(addr + 1);
+      const auto operand = ins.size == 3 ? memory.word(next) : static_cast<Address>(memory[next]);
+      switch (ins.mode) {
+      case ZeroPage:
+      case Absolute: targets.push_back(operand); break;
+      case ZeroPageX:
+      case ZeroPageY: targets.push_back({0x00, 0xff}); break;
+      case AbsoluteX:
+      case AbsoluteY: targets.push_back({operand, static_cast<Address>(std::min(operand + 0xff, 0xffff))}); break;
+      default: break;
+      }
+    }
+  }
+  return targets;
+}
+
+void StaticRecompiler::analyze() {
+  leaders.clear();
+  basicBlocks.clear();
+  writtenBlocks.clear();
+  findLeaders();
+  for (const auto first : leaders) {
+    if (auto block = collectBlock(first); !block.instructions.empty()) basicBlocks[first] = block;
+  }
+
+  // code changed by the program has to be read from memory when run, the interpreter does it
+  const auto targets = storeTargets();
+  for (auto it = basicBlocks.begin(); it != basicBlocks.end();) {
+    const auto range = it->second.range;
+    if (std::any_of(targets.begin(), targets.end(), [&](auto target) { return target.overlapsWith(range); })) {
+      writtenBlocks.push_back(range);
+      it = basicBlocks.erase(it);
+    } else {
+      it++;
+    }
+  }
+}
+
+QString StaticRecompiler::generate() const {
+  QString source;
+  QTextStream out(&source);
+
+  out << "// generated by mo65x static recompiler, do not edit\n\n";
+  out << "#include \"recompiledcode.h\"\n";
+  out << "#include <algorithm>\n\n";
+
+  out << "static const uint8_t Image[] = {";
+  for (int addr = image.first; addr <= image.last; addr++) {
+    out << ((addr - image.first) % 16 ? " " : "\n    ") << "0x" << formatHexByte(memory[static_cast<Address>(addr)]) << ",";
+  }
+  out << "\n};\n\n";
+
+  out << "Address RecompiledCode::entry() {\n";
+  out << "  return " << hexLiteral(entryPoints.empty() ? image.first : entryPoints.front()) << ";\n";
+  out << "}\n\n";
+
+  out << "void RecompiledCode::load(Memory& memory) {\n";
+  out << "  std::copy(std::begin(Image), std::end(Image), memory.begin() + " << hexLiteral(image.first) << ");\n";
+  out << "}\n";
+
+  Disassembler disassembler(memory);
+  for (const auto& [first, block] : basicBlocks) {
+    long cycles = 0;
+    for (const auto addr : block.instructions) cycles += InstructionTable[memory[addr]].cycles;
+
+    out << "\n// $" << formatHexWord(block.range.first) << "-$" << formatHexWord(block.range.last) << "\n";
+    out << "static void block_" << formatHexWord(first) << "(Cpu& cpu) {\n";
+    out << "  RecompiledCode::addCycles(cpu, " << cycles << ");\n";
+    for (const auto addr : block.instructions) {
+      const auto& ins = InstructionTable[memory[addr]];
+      uint16_t operand = 0;
+      if (ins.size == 2) operand = memory[static_cast<Address>(addr + 1)];
+      if (ins.size == 3) operand = memory.word(static_cast<Address>(addr + 1));
+      disassembler.setOrigin(addr);
+      out << "  RecompiledCode::exec<" << MnemonicTable.at(ins.type) << ", " << OperandsFormatNames.at(ins.mode) << ">(cpu, "
+          << hexLiteral(operand) << "); // $" << formatHexWord(addr) << " " << disassembler.disassemble().trimmed() << "\n";
+    }
+    out << "}\n";
+  }
+
+  for (const auto range : writtenBlocks)
+    out << "\n// $" << formatHexWord(range.first) << "-$" << formatHexWord(range.last) << " written by the program, interpreted\n";
+
+  out << "\nbool RecompiledCode::runBlock(Cpu& cpu) {\n";
+  out << "  switch (cpu.regs.pc) {\n";
+  for (const auto& entry : basicBlocks) {
+    const auto name = formatHexWord(entry.first);
+    out << "  case 0x" << name << ": block_" << name << "(cpu); return true;\n";
+  }
+  out << "  default: return false;\n";
+  out << "  }\n";
+  out << "}\n";
+
+  return source;
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include "addressrange.h"
+#include "commondefs.h"
+#include "memory.h"
+#include <QString>
+#include <map>
+#include <set>
+#include <vector>
+
+// Translates program image into C++ source with one function per reachable basic block. Generated code is meant to be
+// compiled together with the emulator core and recompiledcode.h, jumps to addresses not known at recompilation time
+// (indirect JMP, RTS, RTI, interrupts) are resolved at run time and fall back to the interpreter when needed. Blocks
+// the program stores to with absolute or zero page addressing are left to the interpreter as well, stores through
+// pointers aren't seen.
+
+class StaticRecompiler {
+public:
+  struct Block {
+    AddressRange range;
+    std::vector<Address> instructions;
+  };
+
+  StaticRecompiler(const Memory&, AddressRange image);
+  void addEntryPoint(Address);
+  void analyze();
+  const std::map<Address, Block>& blocks() const { return basicBlocks; }
+  const std::vector<AddressRange>& interpretedRanges() const { return writtenBlocks; }
+  QString generate() const;
+
+private:
+  const Memory& memory;
+  const AddressRange image;
+  std::vector<Address> entryPoints;
+  std::set<Address> leaders;
+  std::map<Address, Block> basicBlocks;
+  std::vector<AddressRange> writtenBlocks;
+
+  bool fitsInImage(Address) const;
+  void findLeaders();
+  Block collectBlock(Address first) const;
+  std::vector<AddressRange> storeTargets() const;
+};
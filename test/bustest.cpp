@@ -0,0 +1,101 @@
+#include "bustest.h"
+#include "instructiontable.h"
+#include <QTest>
+#include <random>
+
+static constexpr auto CodeOrigin = 0x600;
+
+BusTest::BusTest(QObject* parent) : QObject(parent), cpu(memory), fastCpu(fastMemory) {
+  cpu.changeEngine(CpuEngine::CycleExact);
+  cpu.observeBus([this](long cycle, Address address, uint8_t value, BusAccess access) {
+    accesses << QString("%1 %2 %3 %4")
+                    .arg(cycle)
+                    .arg(access == BusAccess::Read ? 'r' : 'w')
+                    .arg(address, 4, 16, QChar('0'))
+                    .arg(value, 2, 16, QChar('0'));
+  });
+}
+
+void BusTest::run(std::initializer_list<uint8_t> code) {
+  std::copy(code.begin(), code.end(), memory.begin() + CodeOrigin);
+  cpu.regs.pc = CodeOrigin;
+  cpu.execute(false);
+}
+
+void BusTest::init() {
+  std::fill(memory.begin(), memory.end(), 0);
+  cpu.changeVariant(CpuVariant::Nmos);
+  cpu.reset();
+  cpu.regs.sp.offset = 0xff;
+  cpu.regs.p = 0;
+  accesses.clear();
+}
+
+void BusTest::testSameResultsAsFastBus() {
+  fastCpu.changeEngine(CpuEngine::Threaded);
+  std::mt19937 random;
+  for (const auto variant : {CpuVariant::Nmos, CpuVariant::NmosUndocumented, CpuVariant::Cmos65C02}) {
+    cpu.changeVariant(variant);
+    fastCpu.changeVariant(variant);
+    for (int opCode = 0; opCode < Instruction::NumberOfOpCodes; opCode++) {
+      for (int sample = 0; sample < 4; sample++) {
+        std::generate(memory.begin(), memory.end(), [&] { return static_cast<uint8_t>(random()); });
+        Registers regs;
+        regs.pc = static_cast<Address>(random());
+        regs.a = static_cast<uint8_t>(random());
+        regs.x = static_cast<uint8_t>(random());
+        regs.y = static_cast<uint8_t>(random());
+        regs.sp.offset = static_cast<uint8_t>(random());
+        regs.p = static_cast<uint8_t>(random());
+        memory[regs.pc] = static_cast<uint8_t>(opCode);
+        std::copy(memory.begin(), memory.end(), fastMemory.begin());
+        cpu.reset();
+        fastCpu.reset();
+        cpu.regs = regs;
+        fastCpu.regs = regs;
+        accesses.clear();
+
+        cpu.execute(false);
+        fastCpu.execute(false);
+
+        const auto cycles = cpu.info().executionStatistics.cycles;
+        QCOMPARE(cycles, fastCpu.info().executionStatistics.cycles);
+        QCOMPARE(accesses.size(), cycles);
+        QCOMPARE(cpu.info().state, fastCpu.info().state);
+        QCOMPARE(cpu.regs.pc, fastCpu.regs.pc);
+        QCOMPARE(cpu.regs.a, fastCpu.regs.a);
+        QCOMPARE(cpu.regs.x, fastCpu.regs.x);
+        QCOMPARE(cpu.regs.y, fastCpu.regs.y);
+        QCOMPARE(cpu.regs.sp.offset, fastCpu.regs.sp.offset);
+        QCOMPARE(uint8_t(cpu.regs.p), uint8_t(fastCpu.regs.p));
+        QVERIFY(std::equal(memory.begin(), memory.end(), fastMemory.begin()));
+      }
+    }
+  }
+}
+
+void BusTest::testZeroPageIndexedReadModifyWrite() {
+  memory[0x11] = 0x7f;
+  cpu.regs.x = 0x01;
+  run({0xf6, 0x10}); // INC $10,X
+  QCOMPARE(accesses, QStringList({"0 r 0600 f6", "1 r 0601 10", "2 r 0010 00", "3 r 0011 7f", "4 w 0011 7f",
+                                  "5 w 0011 80"}));
+  QCOMPARE(memory[0x11], 0x80);
+}
+
+void BusTest::testAbsoluteIndexedPageCrossing() {
+  memory[0x2110] = 0x42;
+  cpu.regs.y = 0x20;
+  run({0xb9, 0xf0, 0x20}); // LDA $20F0,Y
+  QCOMPARE(accesses,
+           QStringList({"0 r 0600 b9", "1 r 0601 f0", "2 r 0602 20", "3 r 2010 00", "4 r 2110 42"}));
+  QCOMPARE(cpu.regs.a, 0x42);
+}
+
+void BusTest::testSubroutineCall() {
+  run({0x20, 0x00, 0x07}); // JSR $0700
+  QCOMPARE(accesses, QStringList({"0 r 0600 20", "1 r 0601 00", "2 r 01ff 00", "3 w 01ff 06", "4 w 01fe 02",
+                                  "5 r 0602 07"}));
+  QCOMPARE(cpu.regs.pc, 0x700);
+  QCOMPARE(cpu.regs.sp.offset, 0xfd);
+}
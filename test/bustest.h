@@ -0,0 +1,29 @@
+#pragma once
+
+#include "cpu.h"
+#include <QObject>
+#include <QStringList>
+
+class BusTest : public QObject {
+  Q_OBJECT
+
+public:
+  explicit BusTest(QObject* parent = nullptr);
+
+private:
+  Memory memory;
+  Memory fastMemory;
+  Cpu cpu;
+  Cpu fastCpu;
+  QStringList accesses;
+
+  void run(std::initializer_list<uint8_t> code);
+
+private slots:
+  void init();
+
+  void testSameResultsAsFastBus();
+  void testZeroPageIndexedReadModifyWrite();
+  void testAbsoluteIndexedPageCrossing();
+  void testSubroutineCall();
+};
@@ -0,0 +1,80 @@
+#include "cpubenchmark.h"
+#include "cpuenginerows.h"
+#include <QTest>
+
+static constexpr auto AsmOrigin = 0x600;
+
+// scrollarea routine of demoscene.asm repeated 256 times and terminated with KIL
+
+static const char* const CopyLoopProgram[]{
+    "  LDY #0",
+    "outer:",
+    "  LDX #0",
+    "copy:",
+    "  LDA $521,X",
+    "  STA $520,X",
+    "  LDA $541,X",
+    "  STA $540,X",
+    "  LDA $561,X",
+    "  STA $560,X",
+    "  LDA $581,X",
+    "  STA $580,X",
+    "  LDA $5a1,X",
+    "  STA $5a0,X",
+    "  INX",
+    "  CPX #31",
+    "  BNE copy",
+    "  DEY",
+    "  BNE outer",
+    "  KIL",
+};
+
+CpuBenchmark::CpuBenchmark(QObject* parent) : QObject(parent), assembler(memory), cpu(memory) {
+}
+
+void CpuBenchmark::initTestCase() {
+  std::fill(memory.begin(), memory.end(), 0);
+  assembler.init(AsmOrigin);
+  for (auto mode : {Assembler::ProcessingMode::ScanForSymbols, Assembler::ProcessingMode::EmitCode}) {
+    assembler.initPreserveSymbols(AsmOrigin);
+    assembler.changeMode(mode);
+    for (const auto line : CopyLoopProgram) QCOMPARE(assembler.processLine(line), AssemblyResult::Ok);
+  }
+}
+
+void CpuBenchmark::benchmarkEngine_data() {
+  addCpuEngineRows();
+}
+
+void CpuBenchmark::benchmarkEngine() {
+  QFETCH(CpuEngine, engine);
+  cpu.changeEngine(engine);
+  cpu.reset();
+  QBENCHMARK {
+    cpu.regs.pc = AsmOrigin;
+    cpu.resetExecutionState();
+    cpu.execute(true, Duration::zero());
+  }
+  QCOMPARE(cpu.info().state, CpuState::Halted);
+  QCOMPARE(cpu.regs.x, 31);
+  QCOMPARE(cpu.regs.y, 0);
+}
+
+void CpuBenchmark::benchmarkStepping_data() {
+  benchmarkEngine_data();
+}
+
+// one instruction per call, dominated by the per call handling of the hot CPU state
+void CpuBenchmark::benchmarkStepping() {
+  QFETCH(CpuEngine, engine);
+  cpu.changeEngine(engine);
+  cpu.reset();
+  QBENCHMARK {
+    cpu.regs.pc = AsmOrigin;
+    cpu.resetExecutionState();
+    do cpu.execute(false, Duration::zero());
+    while (cpu.info().state != CpuState::Halted);
+  }
+  QCOMPARE(cpu.regs.x, 31);
+  QCOMPARE(cpu.regs.y, 0);
+}
@@ -0,0 +1,25 @@
+#pragma once
+
+#include "assembler.h"
+#include "cpu.h"
+#include <QObject>
+
+class CpuBenchmark : public QObject {
+  Q_OBJECT
+
+public:
+  explicit CpuBenchmark(QObject* parent = nullptr);
+
+private:
+  Assembler assembler;
+  Memory memory;
+  Cpu cpu;
+
+private slots:
+  void initTestCase();
+
+  void benchmarkEngine_data();
+  void benchmarkEngine();
+  void benchmarkStepping_data();
+  void benchmarkStepping();
+};
@@ -0,0 +1,14 @@
+#pragma once
+
+#include "cpuengine.h"
+#include <QTest>
+
+Q_DECLARE_METATYPE(CpuEngine)
+
+// engine column with a row for each engine, as global data of suites run on all engines or data of a single test
+inline void addCpuEngineRows() {
+  QTest::addColumn<CpuEngine>("engine");
+  for (const auto engine :
+       {CpuEngine::Decoded, CpuEngine::Threaded, CpuEngine::Predecoded, CpuEngine::Translated, CpuEngine::CycleExact})
+    QTest::newRow(formatCpuEngine(engine)) << engine;
+}
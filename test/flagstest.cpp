@@ -56,3 +56,39 @@ void FlagsTest::testOverflow() {
   p.computeV(static_cast<uint8_t>(-120), static_cast<uint8_t>(7), 127);
   QCOMPARE(p.overflow, false);
 }
+
+void FlagsTest::testDeferredNZ() {
+  p = 0;
+  p.deferNZ(0x80);
+  QCOMPARE(p.deferredNegative(), true);
+  QCOMPARE(p.deferredZero(), false);
+  QCOMPARE(p.negative, false);
+  p.resolveNZ();
+  QCOMPARE(p.negative, true);
+  QCOMPARE(p.zero, false);
+
+  p.deferNZC(0x100);
+  p.resolveNZ();
+  QCOMPARE(p.toByte(), ProcessorStatus::ZeroBitMask | ProcessorStatus::CarryBitMask);
+}
+
+void FlagsTest::testDeferredByteConversion() {
+  p = ProcessorStatus::NegativeBitMask | ProcessorStatus::ZeroBitMask;
+  QCOMPARE(p.deferredNegative(), true);
+  QCOMPARE(p.deferredZero(), true);
+
+  p.deferN(0x01);
+  p.deferZ(0x00);
+  p.resolveNZ();
+  QCOMPARE(p.toByte(), ProcessorStatus::ZeroBitMask);
+}
+
+void FlagsTest::testNZTable() {
+  for (int result = 0; result < 256; result++) {
+    p = ProcessorStatus::CarryBitMask;
+    p.computeNZ(static_cast<uint16_t>(result));
+    QCOMPARE(p.negative, bool(result & 0x80));
+    QCOMPARE(p.zero, result == 0);
+    QCOMPARE(p.carry, true);
+  }
+}
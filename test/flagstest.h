@@ -23,4 +23,7 @@ private slots:
   void testZero();
   void testCarry();
   void testOverflow();
+  void testDeferredNZ();
+  void testDeferredByteConversion();
+  void testNZTable();
 };
@@ -0,0 +1,175 @@
+#include "hostservicestest.h"
+#include "cpuenginerows.h"
+#include <QTemporaryDir>
+#include <QTest>
+#include <algorithm>
+#include <cstring>
+#include <utility>
+#include <vector>
+
+static constexpr auto AsmOrigin = 0x0800;
+static constexpr auto Block = 0x0200;
+
+// no service is registered as $FF, test programs halt there
+static constexpr auto Stop = "HCL #$FF";
+static constexpr long StopCycles = 2;
+
+HostServicesTest::HostServicesTest(QObject* parent) : QObject(parent), assembler(memory), cpu(memory) {
+  cpu.hostServices().registerStandardServices([this](const std::string& str) { output += QString::fromStdString(str); });
+}
+
+// programs are assembled one after another, each starting past the stop of the previous one
+void HostServicesTest::run(std::initializer_list<const char*> lines) {
+  cpu.regs.pc = assembler.locationCounter;
+  for (const auto line : lines) QCOMPARE(assembler.processLine(line), AssemblyResult::Ok);
+  QCOMPARE(assembler.processLine(Stop), AssemblyResult::Ok);
+  cpu.execute(true, Duration::zero());
+}
+
+void HostServicesTest::setString(Address addr, const char* str) {
+  std::copy(str, str + std::strlen(str) + 1, memory.begin() + addr);
+}
+
+void HostServicesTest::initTestCase_data() {
+  addCpuEngineRows();
+}
+
+void HostServicesTest::init() {
+  QFETCH_GLOBAL(CpuEngine, engine);
+  cpu.changeEngine(engine);
+  std::fill(memory.begin(), memory.end(), 0);
+  assembler.init(AsmOrigin);
+  assembler.changeMode(Assembler::ProcessingMode::EmitCode);
+  cpu.reset();
+  output.clear();
+}
+
+void HostServicesTest::testUnregisteredServiceHalts() {
+  run({"NOP"});
+  QCOMPARE(cpu.regs.pc, Address(AsmOrigin + 1));
+  QCOMPARE(cpu.info().executionStatistics.cycles, 2L + StopCycles);
+  QCOMPARE(cpu.info().state, CpuState::Halted);
+}
+
+void HostServicesTest::testMultiplyAndDivide() {
+  run({"LDA #200", "LDX #100", "HCL #$00"});
+  QCOMPARE(cpu.regs.a, uint8_t(0x20));
+  QCOMPARE(cpu.regs.x, uint8_t(0x4e));
+  QCOMPARE(cpu.regs.p.negative, false);
+  QCOMPARE(cpu.regs.p.zero, false);
+
+  run({"LDY #7", "HCL #$01"});
+  QCOMPARE(cpu.regs.a, uint8_t(0x29));
+  QCOMPARE(cpu.regs.x, uint8_t(0x0b));
+  QCOMPARE(cpu.regs.y, uint8_t(1));
+  QCOMPARE(cpu.regs.p.carry, false);
+
+  run({"LDY #0", "HCL #$01"});
+  QCOMPARE(cpu.regs.p.carry, true);
+  QCOMPARE(cpu.regs.a, uint8_t(0x29));
+  QCOMPARE(cpu.info().executionStatistics.cycles, 2L * 7 + (HostServices::DefaultCost + StopCycles) * 3);
+}
+
+void HostServicesTest::testCopyMemory() {
+  for (int i = 0; i < 0x300; i++) memory[static_cast<Address>(0x3000 + i)] = static_cast<uint8_t>(i);
+  memory.setWord(Block, 0x3000);
+  memory.setWord(Block + 2, 0x3001);
+  memory.setWord(Block + 4, 0x200);
+  run({"LDX #$00", "LDY #$02", "HCL #$02"});
+  QCOMPARE(memory[0x3000], 0);
+  for (int i = 0; i < 0x200; i++) QCOMPARE(memory[static_cast<Address>(0x3001 + i)], static_cast<uint8_t>(i));
+  QCOMPARE(memory[0x3201], 0x01);
+}
+
+void HostServicesTest::testPrint() {
+  setString(0x3000, "%s: %04x %d %c %u%%");
+  setString(0x3100, "pc");
+  memory.setWord(Block, 0x3000);
+  memory.setWord(Block + 2, 0x3100);
+  memory.setWord(Block + 4, 0xbeef);
+  memory.setWord(Block + 6, 0xfffe);
+  memory.setWord(Block + 8, 'x');
+  memory.setWord(Block + 10, 65535);
+  run({"LDX #$00", "LDY #$02", "HCL #$03"});
+  QCOMPARE(output, "pc: beef -2 x 65535%");
+  QCOMPARE(cpu.regs.a, uint8_t(output.size()));
+}
+
+void HostServicesTest::testFiles() {
+  QTemporaryDir dir;
+  QVERIFY(dir.isValid());
+  const auto fileName = dir.filePath("data.bin").toStdString();
+  setString(0x3000, fileName.c_str());
+  for (int i = 0; i < 0x180; i++) memory[static_cast<Address>(0x4000 + i)] = static_cast<uint8_t>(i * 3);
+  memory.setWord(Block, 0x3000);
+  memory.setWord(Block + 2, 0x4000);
+  memory.setWord(Block + 4, 0x180);
+  memory.setWord(Block + 6, 0x3000);
+  memory.setWord(Block + 8, 0x5000);
+  memory.setWord(Block + 10, 0x1000);
+  run({"LDX #$00", "LDY #$02", "HCL #$05", "LDX #$06", "HCL #$04"});
+  QCOMPARE(cpu.regs.p.carry, false);
+  QCOMPARE(cpu.regs.x, uint8_t(0x80));
+  QCOMPARE(cpu.regs.y, uint8_t(0x01));
+  QVERIFY(std::equal(memory.begin() + 0x4000, memory.begin() + 0x4180, memory.begin() + 0x5000));
+  QCOMPARE(memory[0x5180], 0);
+
+  setString(0x3000, dir.filePath("missing.bin").toStdString().c_str());
+  run({"LDX #$06", "HCL #$04"});
+  QCOMPARE(cpu.regs.p.carry, true);
+  QCOMPARE(cpu.regs.x, uint8_t(0));
+}
+
+void HostServicesTest::testProtectedDestination() {
+  QTemporaryDir dir;
+  QVERIFY(dir.isValid());
+  setString(0x3000, dir.filePath("data.bin").toStdString().c_str());
+  std::fill(memory.begin() + 0x4000, memory.begin() + 0x4210, 0x55);
+  std::fill(memory.begin() + 0x50f0, memory.begin() + 0x5200, 0xaa);
+  memory.writeProtect(0x51, 0x51);
+  std::vector<std::pair<Address, uint8_t>> deviceWrites;
+  memory.mapDevice(0x52, 0x52, {}, [&](Address addr, uint8_t value) { deviceWrites.emplace_back(addr, value); });
+
+  memory.setWord(Block, 0x4000);
+  memory.setWord(Block + 2, 0x5000);
+  memory.setWord(Block + 4, 0x210);
+  run({"LDX #$00", "LDY #$02", "HCL #$02"});
+  QVERIFY(std::all_of(memory.begin() + 0x5000, memory.begin() + 0x5100, [](auto value) { return value == 0x55; }));
+  QVERIFY(std::all_of(memory.begin() + 0x5100, memory.begin() + 0x5200, [](auto value) { return value == 0xaa; }));
+  QCOMPARE(deviceWrites.size(), size_t(0x10));
+  QCOMPARE(deviceWrites.front(), std::make_pair(Address(0x5200), uint8_t(0x55)));
+
+  memory.setWord(Block, 0x3000);
+  memory.setWord(Block + 2, 0x4000);
+  memory.setWord(Block + 4, 0x200);
+  memory.setWord(Block + 6, 0x3000);
+  memory.setWord(Block + 8, 0x50f0);
+  memory.setWord(Block + 10, 0x200);
+  std::fill(memory.begin() + 0x4000, memory.begin() + 0x4200, 0x33);
+  run({"LDX #$00", "LDY #$02", "HCL #$05", "LDX #$06", "HCL #$04"});
+  QCOMPARE(cpu.regs.p.carry, false);
+  QCOMPARE(memory[0x50ff], 0x33);
+  QCOMPARE(memory[0x5100], 0xaa);
+  QCOMPARE(memory[0x51ff], 0xaa);
+  QCOMPARE(deviceWrites.size(), size_t(0x10 + 0xf0));
+  QCOMPARE(deviceWrites.back(), std::make_pair(Address(0x52ef), uint8_t(0x33)));
+
+  memory.unmapDevice(0x51, 0x52);
+}
+
+void HostServicesTest::testCustomService() {
+  cpu.hostServices().registerService(
+      0x80, [](HostCall& call) { call.regs.a = static_cast<uint8_t>(call.regs.a + call.memory[0x10]); }, 100);
+  memory[0x10] = 5;
+  run({"LDA #$20", "HCL #$80", "STA $11"});
+  QCOMPARE(memory[0x11], 0x25);
+  QCOMPARE(cpu.info().executionStatistics.cycles, 2L + 2 + 100 + 3 + StopCycles);
+
+  cpu.hostServices().changeCost(0x80, 10);
+  run({"HCL #$80"});
+  QCOMPARE(cpu.regs.a, uint8_t(0x2a));
+  QCOMPARE(cpu.info().executionStatistics.cycles, 2L + 2 + 100 + 3 + StopCycles + 2 + 10 + StopCycles);
+
+  cpu.hostServices().unregisterService(0x80);
+  QVERIFY(!cpu.hostServices().registered(0x80));
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+#include "assembler.h"
+#include "cpu.h"
+#include <QObject>
+#include <QString>
+
+class HostServicesTest : public QObject {
+  Q_OBJECT
+
+public:
+  explicit HostServicesTest(QObject* parent = nullptr);
+
+private:
+  Assembler assembler;
+  Memory memory;
+  Cpu cpu;
+  QString output;
+
+  void run(std::initializer_list<const char*> lines);
+  void setString(Address addr, const char* str);
+
+private slots:
+  void initTestCase_data();
+  void init();
+
+  void testUnregisteredServiceHalts();
+  void testMultiplyAndDivide();
+  void testCopyMemory();
+  void testPrint();
+  void testFiles();
+  void testProtectedDestination();
+  void testCustomService();
+};
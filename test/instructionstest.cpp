@@ -1,7 +1,11 @@
 #include "instructionstest.h"
+#include "cpuenginerows.h"
 #include "disassembler.h"
 #include <QTest>
 #include <algorithm>
+#include <map>
+#include <tuple>
+#include <thread>
 
 #define TEST_NZC(n, z, c)                                                                                                        \
   QCOMPARE(cpu.regs.p.negative, n);                                                                                              \
@@ -42,7 +46,7 @@
 
 #define TEST_BRANCH_TAKEN()                                                                                                      \
   const auto base = assembler.locationCounter;                                                                                   \
-  QCOMPARE(cpu.regs.pc, base + static_cast<int8_t>(*cpu.operandPtr.lo));                                                         \
+  QCOMPARE(cpu.regs.pc, base + static_cast<int8_t>(memory[base - 1]));                                                           \
   QCOMPARE(cpu.cycles, (base ^ cpu.regs.pc) & 0xff00 ? 4 : 3)
 
 #define TEST_BRANCH_NOT_TAKEN()                                                                                                  \
@@ -52,9 +56,41 @@
 static constexpr auto AsmOrigin = 0x800;
 static constexpr auto StackPointerOffset = 0xff;
 
+// ADC and SBC as computed before the ALU tables, reference for the exhaustive test
+
+struct ArithmeticResult {
+  uint8_t a;
+  bool n, z, c, v;
+};
+
+static bool referenceDecimalCorrection(uint16_t& result) {
+  if ((result & 0x0f) > 0x09) result += 0x06;
+  if ((result & 0xf0) > 0x90) {
+    result += 0x60;
+    return true;
+  }
+  return false;
+}
+
+static ArithmeticResult referenceArithmetic(bool subtract, bool decimal, bool carry, uint8_t a, uint8_t op2) {
+  if (subtract) op2 ^= 0xff;
+  uint16_t result = a + op2 + carry;
+  bool c = result & 0xff00;
+  if (decimal) {
+    if (subtract) result -= 0x66;
+    c = referenceDecimalCorrection(result);
+  }
+  return {static_cast<uint8_t>(result), bool(result & 0x80), !(result & 0xff), c,
+          bool((a ^ result) & (op2 ^ result) & 0x80)};
+}
+
 InstructionsTest::InstructionsTest(QObject* parent) : QObject(parent), assembler(memory), cpu(memory) {
 }
 
+void InstructionsTest::initTestCase_data() {
+  addCpuEngineRows();
+}
+
 void InstructionsTest::initTestCase() {
   QVERIFY(&cpu.memory == &memory);
   std::fill(memory.begin(), memory.end(), 0);
@@ -62,8 +98,11 @@ void InstructionsTest::initTestCase() {
 }
 
 void InstructionsTest::init() {
+  QFETCH_GLOBAL(CpuEngine, engine);
+  cpu.changeEngine(engine);
   assembler.init(AsmOrigin);
   assembler.changeMode(Assembler::ProcessingMode::EmitCode);
+  cpu.eventScheduler.clear();
   cpu.reset();
   cpu.regs.pc = AsmOrigin;
   cpu.regs.sp.offset = StackPointerOffset;
@@ -317,6 +356,33 @@ void InstructionsTest::testSBC() {
   TEST_ANZCV(0, 0, 1, 1, 0);
 }
 
+void InstructionsTest::testArithmeticExhaustive() {
+  for (const uint8_t opCode : {0x69, 0xe9}) {
+    memory[AsmOrigin] = opCode;
+    for (const bool decimal : {false, true})
+      for (const bool carry : {false, true})
+        for (int a = 0; a < 256; a++)
+          for (int op = 0; op < 256; op++) {
+            memory[AsmOrigin + 1] = static_cast<uint8_t>(op);
+            cpu.regs.pc = AsmOrigin;
+            cpu.regs.p = 0;
+            cpu.regs.p.decimal = decimal;
+            cpu.regs.p.carry = carry;
+            cpu.regs.a = static_cast<uint8_t>(a);
+            cpu.execute(false);
+            const auto expected = referenceArithmetic(opCode == 0xe9, decimal, carry, uint8_t(a), uint8_t(op));
+            if (cpu.regs.a != expected.a || cpu.regs.p.negative != expected.n || cpu.regs.p.zero != expected.z ||
+                cpu.regs.p.carry != expected.c || cpu.regs.p.overflow != expected.v)
+              QFAIL(qPrintable(QString("opcode %1 decimal %2 carry %3 a %4 operand %5")
+                                   .arg(opCode, 2, 16)
+                                   .arg(decimal)
+                                   .arg(carry)
+                                   .arg(a, 2, 16)
+                                   .arg(op, 2, 16)));
+          }
+  }
+}
+
 void InstructionsTest::testAND() {
   cpu.regs.a = 0x84;
   TEST_INST("AND #$fb", 2);
@@ -885,3 +951,383 @@ void InstructionsTest::testSEI() {
   TEST_INST("SEI", 2);
   QCOMPARE(cpu.regs.p.interrupt, true);
 }
+
+void InstructionsTest::testSelfModifyingCode() {
+  // loop increments operand of its own LDA instruction
+  for (const auto line : {"LDX #$20", "INC $0806", "LDA #$00", "DEX", "BNE -8", "KIL"})
+    QCOMPARE(assembler.processLine(line), AssemblyResult::Ok);
+  cpu.execute(true, Duration::zero());
+  QCOMPARE(cpu.state, CpuState::Halted);
+  QCOMPARE(cpu.regs.a, 0x20);
+  QCOMPARE(cpu.cycles, 417);
+}
+
+void InstructionsTest::testExternalCodeChange() {
+  for (const auto line : {"LDA #$11", "KIL"}) QCOMPARE(assembler.processLine(line), AssemblyResult::Ok);
+  cpu.execute(true, Duration::zero());
+  QCOMPARE(cpu.regs.a, 0x11);
+  memory[AsmOrigin + 1] = 0x22;
+  cpu.invalidateCode(AsmOrigin + 1);
+  cpu.regs.pc = AsmOrigin;
+  cpu.execute(true, Duration::zero());
+  QCOMPARE(cpu.regs.a, 0x22);
+}
+
+void InstructionsTest::testFusedSequences() {
+  for (const auto line : {"LDX #$00", "INX", "CPX #$10", "BNE -5", "CLC", "ADC #$10", "KIL"})
+    QCOMPARE(assembler.processLine(line), AssemblyResult::Ok);
+  cpu.regs.a = 0xf8;
+  cpu.execute(true, Duration::zero());
+  QCOMPARE(cpu.state, CpuState::Halted);
+  QCOMPARE(cpu.regs.x, 0x10);
+  QCOMPARE(cpu.regs.pc, AsmOrigin + 10);
+  QCOMPARE(cpu.cycles, 117);
+  TEST_ANZC(0x08, false, false, true);
+}
+
+void InstructionsTest::testIdleLoop() {
+  // polling loop without side effects, the thread waits in it until NMI handler changes the polled location
+  for (const auto line : {"LDA $10", "BEQ -4", "KIL"}) QCOMPARE(assembler.processLine(line), AssemblyResult::Ok);
+  const auto handler = AsmOrigin + 0x10;
+  for (const auto line : {".ORG $0810", "INC $10", "RTI"}) QCOMPARE(assembler.processLine(line), AssemblyResult::Ok);
+  memory.setWord(CpuAddress::NmiVector, handler);
+  memory[0x10] = 0;
+  std::thread nmi([this] {
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    cpu.triggerNmi();
+  });
+  cpu.execute(true, Duration::zero());
+  nmi.join();
+  QCOMPARE(cpu.state, CpuState::Halted);
+  QCOMPARE(cpu.regs.pc, AsmOrigin + 4);
+  QCOMPARE(cpu.regs.a, 0x01);
+}
+
+void InstructionsTest::testNativeRoutines() {
+  QFETCH_GLOBAL(CpuEngine, engine);
+  for (const auto line : {"LDX #$00", "LDA $1000,X", "STA $2000,X", "INX", "BNE -9", "LDA #$00", "LDY #$00", "STA $3000,Y",
+                          "DEY", "BNE -6", "KIL"})
+    QCOMPARE(assembler.processLine(line), AssemblyResult::Ok);
+  for (int i = 0; i < 0x100; i++) {
+    memory[static_cast<Address>(0x1000 + i)] = static_cast<uint8_t>(i);
+    memory[static_cast<Address>(0x3000 + i)] = 0xff;
+  }
+  cpu.changeHighLevelEmulation(true);
+  cpu.execute(true, Duration::zero());
+  cpu.changeHighLevelEmulation(false);
+  QCOMPARE(cpu.state, CpuState::Halted);
+  QVERIFY(std::equal(&memory[0x1000], &memory[0x1100], &memory[0x2000]));
+  QVERIFY(std::all_of(&memory[0x3000], &memory[0x3100], [](uint8_t b) { return b == 0; }));
+  QCOMPARE(cpu.regs.a, 0x00);
+  QCOMPARE(cpu.cycles, 6148);
+  // only translated blocks are matched against the loop shapes
+  const auto routines = cpu.replacedRoutines();
+  QCOMPARE(routines.size(), engine == CpuEngine::Translated ? 2U : 0U);
+  if (!routines.empty()) {
+    QCOMPARE(routines.front().type, NativeRoutineType::Copy);
+    QCOMPARE(routines.back().type, NativeRoutineType::Clear);
+  }
+}
+
+void InstructionsTest::testScheduledEvents() {
+  // timer raising IRQ every 1000 cycles, each comes at the first instruction boundary after its cycle
+  for (const auto line : {"CLI", "INC $10", "JMP $0801"}) QCOMPARE(assembler.processLine(line), AssemblyResult::Ok);
+  const auto handler = AsmOrigin + 0x10;
+  for (const auto line : {".ORG $0810", "INC $20", "RTI"}) QCOMPARE(assembler.processLine(line), AssemblyResult::Ok);
+  memory.setWord(CpuAddress::IrqVector, handler);
+  memory[0x20] = 0;
+  std::vector<long> fired;
+  EventHandler timer = [&](long cycle) {
+    fired.push_back(cpu.cycles - cycle);
+    cpu.triggerIrq();
+    cpu.scheduleEvent(cycle + 1000, timer);
+  };
+  cpu.scheduleEvent(1000, timer);
+  cpu.executeUntil(100000, Duration::zero());
+  QCOMPARE(cpu.state, CpuState::Idle);
+  QVERIFY(cpu.cycles >= 100000 && cpu.cycles < 100007);
+  QCOMPARE(fired.size(), 100U);
+  QVERIFY(std::all_of(fired.begin(), fired.end(), [](long late) { return late >= 0 && late < 7; }));
+  // the last IRQ is taken but its handler doesn't run before the limit
+  QCOMPARE(memory[0x20], 99);
+}
+
+void InstructionsTest::testExecuteUntil() {
+  // idle loops are skipped up to the limit, which is still met at the exact instruction
+  QCOMPARE(assembler.processLine("JMP $0800"), AssemblyResult::Ok);
+  long stopped = 0;
+  cpu.scheduleEvent(1000001, [&](long) { stopped = cpu.cycles; });
+  cpu.executeUntil(10000000, Duration::zero());
+  QCOMPARE(cpu.state, CpuState::Idle);
+  QCOMPARE(cpu.cycles, 10000002);
+  QCOMPARE(stopped, 1000002);
+
+  const auto id = cpu.scheduleEvent(cpu.cycles + 10, [](long) { QFAIL("cancelled event has run"); });
+  QVERIFY(cpu.cancelEvent(id));
+  cpu.scheduleEvent(cpu.cycles + 100, [this](long) { cpu.stopExecution(); });
+  cpu.execute(true, Duration::zero());
+  QCOMPARE(cpu.state, CpuState::Stopped);
+  QCOMPARE(cpu.cycles, 10000002 + 102);
+}
+
+void InstructionsTest::testHangDetection() {
+  // flag toggled forever, state repeats though memory is written all the time
+  for (const auto line : {"LDA $10", "EOR #$01", "STA $10", "JSR $0810", "JMP $0800", ".ORG $0810", "INX", "RTS"})
+    QCOMPARE(assembler.processLine(line), AssemblyResult::Ok);
+  cpu.changeHangDetection(10000);
+  cpu.execute(true, Duration::zero());
+  QCOMPARE(cpu.state, CpuState::Stopped);
+  QVERIFY(cpu.hangReport().has_value());
+  QCOMPARE(cpu.hangReport()->cause, HangCause::Loop);
+  QCOMPARE(cpu.hangReport()->loop.first, AsmOrigin);
+  QCOMPARE(cpu.hangReport()->loop.last, AsmOrigin + 0x11);
+  QCOMPARE(cpu.hangReport()->period % 6400, 0);
+
+  cpu.regs.pc = AsmOrigin + 0x20;
+  memory[AsmOrigin + 0x20] = 0x02;
+  cpu.execute(true, Duration::zero());
+  QCOMPARE(cpu.state, CpuState::Halted);
+  QCOMPARE(cpu.hangReport()->cause, HangCause::Halted);
+  QCOMPARE(cpu.hangReport()->loop.first, AsmOrigin + 0x20);
+  cpu.changeHangDetection(0);
+}
+
+void InstructionsTest::testDevicePages() {
+  // device polled until it gets ready, its registers are never in RAM, indexing crosses into RAM
+  std::vector<std::pair<Address, uint8_t>> writes;
+  int polls = 0;
+  memory.mapDevice(0xd0, 0xd0, [&](Address addr) { return static_cast<uint8_t>(addr == 0xd011 && ++polls >= 100 ? 0x80 : 0x21); },
+                   [&](Address addr, uint8_t value) { writes.emplace_back(addr, value); });
+  for (const auto line : {"LDA $D011", "BPL $0800", "LDA $D012", "STA $20", "INC $D020", "LDA #$05", "STA $D0FF,Y", "KIL"})
+    QCOMPARE(assembler.processLine(line), AssemblyResult::Ok);
+  cpu.regs.y = 0x01;
+  cpu.execute(true, Duration::zero());
+  memory.unmapDevice(0xd0, 0xd0);
+
+  QCOMPARE(cpu.state, CpuState::Halted);
+  QCOMPARE(polls, 100);
+  QCOMPARE(memory[0x20], 0x21);
+  QVERIFY(!writes.empty());
+  QCOMPARE(writes.back(), std::make_pair(Address(0xd020), uint8_t(0x22)));
+  QCOMPARE(memory[0xd020], 0x00);
+  QCOMPARE(memory[0xd100], 0x05);
+  QVERIFY(!memory.device(0xd011));
+  memory[0xd100] = 0;
+}
+
+void InstructionsTest::testProcessorPort() {
+  // KERNAL routine called, writes under ROM go to RAM, BASIC and KERNAL switched out and in again
+  auto& port = cpu.processorPort();
+  Data kernal(0x2000, 0xea);
+  kernal[0] = 0xa9; // LDA #$42
+  kernal[1] = 0x42;
+  kernal[2] = 0x60; // RTS
+  port.loadRom(ProcessorPort::Basic, Data(0x2000, 0xba));
+  port.loadRom(ProcessorPort::Kernal, kernal);
+  uint8_t border = 0;
+  port.mapIo([](Address) { return 0x77; }, [&](Address, uint8_t value) { border = value; });
+  port.enable(true);
+  QCOMPARE(memory[CpuAddress::IoPortConfig], 0x2f);
+  QCOMPARE(memory[CpuAddress::IoPortData], 0x37);
+  QCOMPARE(memory[0xa000], 0xba);
+  for (const auto line : {"JSR $E000", "STA $A000", "STA $D020", "LDA $D012", "STA $10", "LDA #$35", "STA $01", "LDA $A000",
+                          "STA $11", "INC $E000", "LDA #$37", "STA $01", "LDA $E000", "STA $12", "KIL"})
+    QCOMPARE(assembler.processLine(line), AssemblyResult::Ok);
+  const auto since = memory.startGeneration();
+  const auto before = cpu.takeSnapshot();
+  cpu.execute(true, Duration::zero());
+  QCOMPARE(cpu.state, CpuState::Halted);
+  QCOMPARE(border, 0x42);
+  QCOMPARE(memory[0x10], 0x77);
+  QCOMPARE(memory[0x11], 0x42);
+  QCOMPARE(memory[0x12], 0xa9);
+  QCOMPARE(port.hiddenRam(0xa000), 0x42);
+  QCOMPARE(port.hiddenRam(0xe000), 0x01);
+
+  // zero page stores count as written with the port on, snapshots keep them and RAM under ROM
+  QVERIFY(memory.changedPages(since)[0]);
+  const auto after = cpu.takeSnapshot();
+  QCOMPARE(after[0x10], 0x77);
+  QCOMPARE(after[0xa000], 0x42);
+  cpu.restoreSnapshot(before);
+  QCOMPARE(memory[0x10], before[0x10]);
+  QCOMPARE(memory[0x11], before[0x11]);
+  QCOMPARE(port.hiddenRam(0xa000), before[0xa000]);
+
+  // BASIC switched out between a snapshot and its restore is mapped in again, the RAM written meanwhile is gone
+  memory.write(CpuAddress::IoPortData, 0x36);
+  memory.write(0xa000, 0x55);
+  QCOMPARE(memory[0xa000], 0x55);
+  const auto switched = cpu.takeSnapshot();
+  cpu.restoreSnapshot(after);
+  QCOMPARE(port.data(), 0x37);
+  QCOMPARE(memory[CpuAddress::IoPortData], 0x37);
+  QCOMPARE(memory[0xa000], 0xba);
+  QCOMPARE(port.hiddenRam(0xa000), 0x42);
+  cpu.restoreSnapshot(switched);
+  QCOMPARE(port.data(), 0x36);
+  QCOMPARE(memory[0xa000], 0x55);
+  QCOMPARE(memory[0xe000], 0xa9);
+  cpu.restoreSnapshot(after);
+
+  port.enable(false);
+  QCOMPARE(memory[0xa000], 0x42);
+  QCOMPARE(memory[0xe000], 0x01);
+  memory[CpuAddress::IoPortConfig] = memory[CpuAddress::IoPortData] = memory[0xa000] = memory[0xe000] = 0;
+}
+
+void InstructionsTest::testWriteGenerations() {
+  // reads and writes before the generation started aren't reported
+  for (const auto line : {"LDA #$01", "STA $0300", "STA $10", "PHA", "LDA $2000", "INC $2100,X", "KIL"})
+    QCOMPARE(assembler.processLine(line), AssemblyResult::Ok);
+  memory.write(0x4000, 0);
+  const auto since = memory.startGeneration();
+  cpu.execute(true, Duration::zero());
+  cpu.invalidateCode({0x5000, 0x51ff});
+  Memory::PageSet expected;
+  for (const auto page : {0x00, 0x01, 0x03, 0x21, 0x50, 0x51}) expected.set(page);
+  QVERIFY(memory.changedPages(since) == expected);
+  const auto ranges = memory.changedRanges(since);
+  QCOMPARE(ranges.size(), size_t(4));
+  QCOMPARE(ranges.front().last, 0x01ff);
+  QCOMPARE(ranges.back().first, 0x5000);
+  QCOMPARE(ranges.back().last, 0x51ff);
+  QVERIFY(memory.changedPages(memory.startGeneration()).none());
+}
+
+void InstructionsTest::testRewind() {
+  for (const auto line : {"INC $0300", "INC $10", "LDA $10", "CMP #$40", "BNE $0800", "KIL"})
+    QCOMPARE(assembler.processLine(line), AssemblyResult::Ok);
+  memory[0x10] = memory[0x0300] = 0;
+  cpu.changeRewindInterval(100);
+  cpu.executeUntil(500, Duration::zero());
+  const auto before = cpu.takeSnapshot();
+  cpu.execute(false, Duration::zero());
+  QVERIFY(cpu.cycles > before.cycles);
+
+  // one instruction back restores registers and memory
+  QVERIFY(cpu.stepBack());
+  QCOMPARE(cpu.cycles, before.cycles);
+  QCOMPARE(cpu.regs.pc, before.regs.pc);
+  QCOMPARE(cpu.regs.a, before.regs.a);
+  QCOMPARE(memory[0x10], before[0x10]);
+  QCOMPARE(memory[0x0300], before[0x0300]);
+
+  // back to the last LDA $10, which follows the INC
+  QVERIFY(cpu.runBackTo(0x0805));
+  QVERIFY(cpu.cycles < before.cycles);
+  QCOMPARE(cpu.regs.pc, 0x0805);
+  const auto count = memory[0x10];
+  cpu.execute(false, Duration::zero());
+  QCOMPARE(cpu.regs.a, count);
+
+  // an address never executed leaves everything as it was
+  const auto cycles = cpu.cycles;
+  QVERIFY(!cpu.runBackTo(0x0900));
+  QCOMPARE(cpu.cycles, cycles);
+  QCOMPARE(cpu.regs.pc, 0x0807);
+  cpu.changeRewindInterval(0);
+  QVERIFY(!cpu.stepBack());
+
+  // flags come back as a run without rewinding had them, N and Z included though they aren't resolved while running
+  assembler.init(AsmOrigin);
+  for (const auto line : {"LDY #$10", "LDX #$00", "DEX", "BNE $0804", "DEY", "BNE $0804", "KIL"})
+    QCOMPARE(assembler.processLine(line), AssemblyResult::Ok);
+  const auto restart = [&] {
+    cpu.resetStatistics();
+    cpu.resetExecutionState();
+    cpu.regs.pc = AsmOrigin;
+    cpu.regs.p = 0;
+  };
+  restart();
+  std::map<long, uint8_t> flags;
+  while (cpu.state != CpuState::Halted) {
+    flags[cpu.cycles] = cpu.regs.p;
+    cpu.execute(false, Duration::zero());
+  }
+  cpu.changeRewindInterval(100);
+  for (const auto cycle : {1000L, 2345L, 4406L, 6013L, 9000L}) {
+    restart();
+    cpu.executeUntil(cycle, Duration::zero());
+    QVERIFY(cpu.stepBack());
+    QCOMPARE(uint8_t(cpu.regs.p), flags[cpu.cycles]);
+    cpu.executeUntil(cpu.cycles + 500, Duration::zero());
+    QCOMPARE(uint8_t(cpu.regs.p), flags[cpu.cycles]);
+  }
+  cpu.changeRewindInterval(0);
+
+  // with the port on banks are mapped as they were at the instruction gone back to, also right after a switch
+  auto& port = cpu.processorPort();
+  port.loadRom(ProcessorPort::Basic, Data(0x2000, 0xba));
+  port.enable(true);
+  assembler.init(AsmOrigin);
+  for (const auto line : {"LDA #$36", "STA $01", "INC $A000", "LDA #$37", "STA $01", "INC $A000", "LDA $A000", "STA $10",
+                          "JMP $0800"})
+    QCOMPARE(assembler.processLine(line), AssemblyResult::Ok);
+  cpu.resetExecutionState();
+  cpu.regs.pc = AsmOrigin;
+  const auto start = cpu.takeSnapshot();
+  const auto banks = [&] { return std::make_tuple(port.data(), memory[0xa000], port.hiddenRam(0xa000)); };
+  std::map<long, decltype(banks())> seen;
+  cpu.resetStatistics();
+  while (cpu.cycles < 10000) {
+    seen[cpu.cycles] = banks();
+    cpu.execute(false, Duration::zero());
+  }
+  cpu.changeRewindInterval(100);
+  for (const auto cycle : {1000L, 2345L, 4406L, 6013L, 9000L}) {
+    cpu.restoreSnapshot(start);
+    cpu.resetStatistics();
+    cpu.executeUntil(cycle, Duration::zero());
+    QVERIFY(cpu.stepBack());
+    QVERIFY(banks() == seen[cpu.cycles]);
+    QVERIFY(cpu.runBackTo(0x0804));
+    QCOMPARE(port.data(), 0x36);
+    QVERIFY(banks() == seen[cpu.cycles]);
+    while (cpu.regs.pc != 0x0804 && cpu.regs.pc != 0x080b)
+      cpu.execute(false, Duration::zero());
+    const auto next = cpu.regs.pc;
+    QVERIFY(cpu.stepBack());
+    QCOMPARE(cpu.regs.pc, next - 2);
+    QVERIFY(banks() == seen[cpu.cycles]);
+  }
+  cpu.changeRewindInterval(0);
+  port.enable(false);
+  memory[0xa000] = memory[0x10] = 0;
+}
+
+void InstructionsTest::testInputReplay() {
+  // device values summed up, an edit and an NMI between runs, replayed while the device reads something else
+  uint8_t deviceValue = 0;
+  memory.mapDevice(0xd0, 0xd0, [&](Address) { return deviceValue += 7; }, {});
+  for (const auto line : {"LDA $D000", "ADC $10", "STA $10", "INC $11", "JMP $0800"})
+    QCOMPARE(assembler.processLine(line), AssemblyResult::Ok);
+  memory[0x0900] = 0x40; // RTI
+  memory.setWord(CpuAddress::NmiVector, 0x0900);
+  const auto start = cpu.takeSnapshot();
+  cpu.recordInputs(1);
+  cpu.executeUntil(cpu.cycles + 1000, Duration::zero());
+  cpu.recordInput(InputKind::Accumulator, 0, 0x55);
+  cpu.regs.a = 0x55;
+  cpu.triggerNmi();
+  cpu.executeUntil(cpu.cycles + 1000, Duration::zero());
+  const auto log = cpu.inputLog();
+  cpu.stopInputLog();
+  const auto last = cpu.takeSnapshot();
+  QCOMPARE(std::count_if(log.inputs().begin(), log.inputs().end(),
+                         [](const Input& input) { return input.kind == InputKind::Nmi; }),
+           1);
+
+  deviceValue = 0x80;
+  cpu.restoreSnapshot(start);
+  cpu.replayInputs(log);
+  cpu.executeUntil(last.cycles, Duration::zero());
+  cpu.stopInputLog();
+  memory.unmapDevice(0xd0, 0xd0);
+  QCOMPARE(cpu.cycles, last.cycles);
+  QCOMPARE(cpu.regs.pc, last.regs.pc);
+  QCOMPARE(cpu.regs.a, last.regs.a);
+  QCOMPARE(cpu.regs.sp.offset, last.regs.sp.offset);
+  QCOMPARE(memory[0x10], last[0x10]);
+  QCOMPARE(memory[0x11], last[0x11]);
+}
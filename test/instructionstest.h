@@ -17,6 +17,7 @@ private:
 
 private slots:
   // functions executed by QtTest before and after test suite
+  void initTestCase_data();
   void initTestCase();
   // void cleanupTestCase();
 
@@ -47,6 +48,7 @@ private slots:
   void testADC();
   void testADC_decimal();
   void testSBC();
+  void testArithmeticExhaustive();
   void testAND();
   void testEOR();
   void testASL();
@@ -114,4 +116,18 @@ private slots:
   void testSED();
   void testCLI();
   void testSEI();
+
+  void testSelfModifyingCode();
+  void testExternalCodeChange();
+  void testFusedSequences();
+  void testIdleLoop();
+  void testNativeRoutines();
+  void testScheduledEvents();
+  void testExecuteUntil();
+  void testHangDetection();
+  void testDevicePages();
+  void testProcessorPort();
+  void testWriteGenerations();
+  void testRewind();
+  void testInputReplay();
 };
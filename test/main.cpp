@@ -1,6 +1,15 @@
 #include "assemblertest.h"
+#include "bustest.h"
+#include "cpubenchmark.h"
 #include "flagstest.h"
+#include "hostservicestest.h"
 #include "instructionstest.h"
+#include "memorydifftest.h"
+#include "memorysearchtest.h"
+#include "snapshotstest.h"
+#include "staticrecompilertest.h"
+#include "variantstest.h"
+#include "writehistorytest.h"
 #include <QTest>
 #include <assemblyresult.h>
 
@@ -10,6 +19,20 @@ int main(int argc, char** argv) {
   AssemblerTest assemblerTest;
   InstructionsTest opCodesTest;
   FlagsTest flagsTest;
+  StaticRecompilerTest staticRecompilerTest;
+  VariantsTest variantsTest;
+  BusTest busTest;
+  HostServicesTest hostServicesTest;
+  SnapshotsTest snapshotsTest;
+  WriteHistoryTest writeHistoryTest;
+  MemorySearchTest memorySearchTest;
+  MemoryDiffTest memoryDiffTest;
+  CpuBenchmark cpuBenchmark;
 
-  return QTest::qExec(&opCodesTest, argc, argv) | QTest::qExec(&assemblerTest, argc, argv) | QTest::qExec(&flagsTest, argc, argv);
+  return QTest::qExec(&opCodesTest, argc, argv) | QTest::qExec(&assemblerTest, argc, argv) | QTest::qExec(&flagsTest, argc, argv) |
+         QTest::qExec(&staticRecompilerTest, argc, argv) | QTest::qExec(&variantsTest, argc, argv) |
+         QTest::qExec(&busTest, argc, argv) | QTest::qExec(&hostServicesTest, argc, argv) |
+         QTest::qExec(&snapshotsTest, argc, argv) | QTest::qExec(&writeHistoryTest, argc, argv) |
+         QTest::qExec(&memorySearchTest, argc, argv) | QTest::qExec(&memoryDiffTest, argc, argv) |
+         QTest::qExec(&cpuBenchmark, argc, argv);
 }
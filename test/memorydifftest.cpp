@@ -0,0 +1,52 @@
+#include "memorydifftest.h"
+#include "memorydiff.h"
+#include <QTest>
+#include <algorithm>
+
+static constexpr auto AsmOrigin = 0x0800;
+
+MemoryDiffTest::MemoryDiffTest(QObject* parent) : QObject(parent), assembler(memory), cpu(memory) {
+}
+
+// a subroutine filling a line of the frame buffer across a page, values written back unchanged aren't reported
+void MemoryDiffTest::init() {
+  std::fill(memory.begin(), memory.end(), 0);
+  // bytes set directly are touched, snapshots would keep the pages of earlier tests otherwise
+  memory.touch(AddressRange::Max);
+  assembler.init(AsmOrigin);
+  assembler.changeMode(Assembler::ProcessingMode::EmitCode);
+  for (const auto line : {"JSR $0804", "KIL", "LDX #$03", "LDA $0210", "STA $0210", "LDA #$01", "STA $02FE,X", "STA $0300,X",
+                          "DEX", "BNE $080E", "RTS"})
+    QCOMPARE(assembler.processLine(line), AssemblyResult::Ok);
+  memory[0x0301] = 1;
+  cpu.reset();
+  cpu.regs.pc = AsmOrigin;
+  cpu.regs.sp.offset = 0xff;
+}
+
+void MemoryDiffTest::testSnapshotsCompared() {
+  const auto before = cpu.takeSnapshot();
+  cpu.execute(true, Duration::zero());
+  const auto after = cpu.takeSnapshot();
+
+  const MemoryDiff diff(before, after);
+  QCOMPARE(diff.ranges().size(), size_t(3));
+  QCOMPARE(diff.ranges()[0].first, 0x01fe);
+  QCOMPARE(diff.ranges()[0].last, 0x01ff);
+  QCOMPARE(diff.ranges()[1].first, 0x02ff);
+  QCOMPARE(diff.ranges()[1].last, 0x0300);
+  QCOMPARE(diff.ranges()[2].first, 0x0302);
+  QCOMPARE(diff.ranges()[2].last, 0x0303);
+  QCOMPARE(diff.count(), size_t(6));
+  QVERIFY(!diff.contains(0x0210));
+  QVERIFY(MemoryDiff(after, after).empty());
+}
+
+void MemoryDiffTest::testSnapshotComparedWithMemory() {
+  cpu.execute(true, Duration::zero());
+  const auto after = cpu.takeSnapshot();
+  QVERIFY(MemoryDiff(after, memory).empty());
+  memory[0x8000]++;
+  QCOMPARE(MemoryDiff(after, memory).ranges().front().first, 0x8000);
+  QCOMPARE(MemoryDiff(after, memory).count(), size_t(1));
+}
@@ -0,0 +1,23 @@
+#pragma once
+
+#include "assembler.h"
+#include "cpu.h"
+#include <QObject>
+
+class MemoryDiffTest : public QObject {
+  Q_OBJECT
+
+public:
+  explicit MemoryDiffTest(QObject* parent = nullptr);
+
+private:
+  Assembler assembler;
+  Memory memory;
+  Cpu cpu;
+
+private slots:
+  void init();
+
+  void testSnapshotsCompared();
+  void testSnapshotComparedWithMemory();
+};
@@ -0,0 +1,56 @@
+#include "memorysearchtest.h"
+#include "memorysearch.h"
+#include <QTest>
+#include <algorithm>
+
+static constexpr auto AsmOrigin = 0x0800;
+
+MemorySearchTest::MemorySearchTest(QObject* parent) : QObject(parent), assembler(memory), cpu(memory) {
+}
+
+void MemorySearchTest::run() {
+  cpu.regs.pc = AsmOrigin;
+  cpu.execute(true, Duration::zero());
+}
+
+// lives counted down by one and a word score going up, found in memory between runs
+void MemorySearchTest::init() {
+  std::fill(memory.begin(), memory.end(), 0);
+  assembler.init(AsmOrigin);
+  assembler.changeMode(Assembler::ProcessingMode::EmitCode);
+  for (const auto line : {"DEC $0340", "CLC", "LDA $0350", "ADC #$23", "STA $0350", "LDA $0351", "ADC #$01", "STA $0351", "KIL"})
+    QCOMPARE(assembler.processLine(line), AssemblyResult::Ok);
+  memory[0x0340] = 5;
+  memory.setWord(0x0350, 0x01f0);
+  cpu.reset();
+}
+
+void MemorySearchTest::testNarrowBytes() {
+  MemorySearch search;
+  search.start(memory);
+  QCOMPARE(search.count(), Memory::Size);
+  run();
+  search.narrow(memory, SearchCondition::ChangedBy, SearchSize::Byte, -1);
+  search.narrow(memory, SearchCondition::EqualTo, SearchSize::Byte, 4);
+  QCOMPARE(search.count(), size_t(1));
+  QVERIFY(search.contains(0x0340));
+}
+
+void MemorySearchTest::testNarrowWords() {
+  MemorySearch search;
+  search.start(memory);
+  run();
+  search.narrow(memory, SearchCondition::ChangedBy, SearchSize::Word, 0x0123);
+  run();
+  search.narrow(memory, SearchCondition::Increased, SearchSize::Word);
+  QCOMPARE(search.addresses(2), std::vector<Address>{0x0350});
+  QCOMPARE(search.value(0x0350, SearchSize::Word), 0x0436);
+}
+
+void MemorySearchTest::testPatterns() {
+  MemorySearch search;
+  search.start(memory);
+  QVERIFY(search.narrow(memory, {{0xce, 0x00, 0x03}, {0xff, 0x00, 0xff}}));
+  QVERIFY(search.contains(AsmOrigin));
+  QVERIFY(!search.narrow(memory, {Data(MemorySearch::MaxPatternSize + 1), {}}));
+}
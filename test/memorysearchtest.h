@@ -0,0 +1,26 @@
+#pragma once
+
+#include "assembler.h"
+#include "cpu.h"
+#include <QObject>
+
+class MemorySearchTest : public QObject {
+  Q_OBJECT
+
+public:
+  explicit MemorySearchTest(QObject* parent = nullptr);
+
+private:
+  Assembler assembler;
+  Memory memory;
+  Cpu cpu;
+
+  void run();
+
+private slots:
+  void init();
+
+  void testNarrowBytes();
+  void testNarrowWords();
+  void testPatterns();
+};
@@ -0,0 +1,73 @@
+// generated by mo65x static recompiler, do not edit
+
+#include "recompiledcode.h"
+#include <algorithm>
+
+static const uint8_t Image[] = {
+    0xa2, 0x00, 0x8a, 0x0a, 0x9d, 0x00, 0x07, 0x20, 0x13, 0x06, 0xe8, 0x8e, 0x15, 0x06, 0xe0, 0x20,
+    0xd0, 0xf0, 0x02, 0x18, 0x69, 0x00, 0x65, 0x10, 0x85, 0x10, 0x90, 0x02, 0xe6, 0x11, 0x60,
+};
+
+Address RecompiledCode::entry() {
+  return 0x0600;
+}
+
+void RecompiledCode::load(Memory& memory) {
+  std::copy(std::begin(Image), std::end(Image), memory.begin() + 0x0600);
+}
+
+// $0600-$0601
+static void block_0600(Cpu& cpu) {
+  RecompiledCode::addCycles(cpu, 2);
+  RecompiledCode::exec<LDX, Immediate>(cpu, 0x0000); // $0600 A2 00     LDX #$00
+}
+
+// $0602-$0609
+static void block_0602(Cpu& cpu) {
+  RecompiledCode::addCycles(cpu, 15);
+  RecompiledCode::exec<TXA, ImpliedOrAccumulator>(cpu, 0x0000); // $0602 8A        TXA
+  RecompiledCode::exec<ASL, ImpliedOrAccumulator>(cpu, 0x0000); // $0603 0A        ASL
+  RecompiledCode::exec<STA, AbsoluteX>(cpu, 0x0700); // $0604 9D 00 07  STA $0700,X
+  RecompiledCode::exec<JSR, Absolute>(cpu, 0x0613); // $0607 20 13 06  JSR $0613
+}
+
+// $060a-$0611
+static void block_060a(Cpu& cpu) {
+  RecompiledCode::addCycles(cpu, 10);
+  RecompiledCode::exec<INX, ImpliedOrAccumulator>(cpu, 0x0000); // $060a E8        INX
+  RecompiledCode::exec<STX, Absolute>(cpu, 0x0615); // $060b 8E 15 06  STX $0615
+  RecompiledCode::exec<CPX, Immediate>(cpu, 0x0020); // $060e E0 20     CPX #$20
+  RecompiledCode::exec<BNE, Branch>(cpu, 0x00f0); // $0610 D0 F0     BNE -16
+}
+
+// $0612-$0612
+static void block_0612(Cpu& cpu) {
+  RecompiledCode::addCycles(cpu, 0);
+  RecompiledCode::exec<KIL, ImpliedOrAccumulator>(cpu, 0x0000); // $0612 02        KIL
+}
+
+// $061c-$061d
+static void block_061c(Cpu& cpu) {
+  RecompiledCode::addCycles(cpu, 5);
+  RecompiledCode::exec<INC, ZeroPage>(cpu, 0x0011); // $061c E6 11     INC $11
+}
+
+// $061e-$061e
+static void block_061e(Cpu& cpu) {
+  RecompiledCode::addCycles(cpu, 6);
+  RecompiledCode::exec<RTS, ImpliedOrAccumulator>(cpu, 0x0000); // $061e 60        RTS
+}
+
+// $0613-$061b written by the program, interpreted
+
+bool RecompiledCode::runBlock(Cpu& cpu) {
+  switch (cpu.regs.pc) {
+  case 0x0600: block_0600(cpu); return true;
+  case 0x0602: block_0602(cpu); return true;
+  case 0x060a: block_060a(cpu); return true;
+  case 0x0612: block_0612(cpu); return true;
+  case 0x061c: block_061c(cpu); return true;
+  case 0x061e: block_061e(cpu); return true;
+  default: return false;
+  }
+}
@@ -0,0 +1,43 @@
+#include "snapshotstest.h"
+#include <QTest>
+#include <algorithm>
+
+static constexpr auto AsmOrigin = 0x0800;
+
+SnapshotsTest::SnapshotsTest(QObject* parent) : QObject(parent), assembler(memory), cpu(memory) {
+}
+
+void SnapshotsTest::init() {
+  std::fill(memory.begin(), memory.end(), 0);
+  assembler.init(AsmOrigin);
+  assembler.changeMode(Assembler::ProcessingMode::EmitCode);
+  cpu.reset();
+  cpu.regs.pc = AsmOrigin;
+}
+
+void SnapshotsTest::testRestoreAndRunAgain() {
+  // counter run to its end, back to the middle and run to the end again
+  for (const auto line : {"INC $0300", "INC $10", "LDA $10", "CMP #$40", "BNE $0800", "KIL"})
+    QCOMPARE(assembler.processLine(line), AssemblyResult::Ok);
+  const auto first = cpu.takeSnapshot();
+  cpu.executeUntil(500, Duration::zero());
+  const auto middle = cpu.takeSnapshot();
+  cpu.execute(true, Duration::zero());
+  const auto last = cpu.takeSnapshot();
+  QCOMPARE(last.state, CpuState::Halted);
+  QCOMPARE(last[0x10], 0x40);
+  QVERIFY(middle.pages[0x08] == first.pages[0x08] && last.pages[0x08] == first.pages[0x08]);
+  QVERIFY(middle.pages[0x03] != first.pages[0x03] && last.pages[0x03] != middle.pages[0x03]);
+
+  cpu.restoreSnapshot(middle);
+  QCOMPARE(cpu.info().state, CpuState::Idle);
+  QCOMPARE(cpu.info().executionStatistics.cycles, middle.cycles);
+  QCOMPARE(memory[0x10], middle[0x10]);
+  QCOMPARE(memory[0x0300], middle[0x0300]);
+  cpu.execute(true, Duration::zero());
+  QCOMPARE(cpu.info().executionStatistics.cycles, last.cycles);
+  int differences = 0;
+  for (size_t addr = 0; addr < Memory::Size; addr++)
+    differences += memory[static_cast<Address>(addr)] != last[static_cast<Address>(addr)];
+  QCOMPARE(differences, 0);
+}
@@ -0,0 +1,22 @@
+#pragma once
+
+#include "assembler.h"
+#include "cpu.h"
+#include <QObject>
+
+class SnapshotsTest : public QObject {
+  Q_OBJECT
+
+public:
+  explicit SnapshotsTest(QObject* parent = nullptr);
+
+private:
+  Assembler assembler;
+  Memory memory;
+  Cpu cpu;
+
+private slots:
+  void init();
+
+  void testRestoreAndRunAgain();
+};
@@ -0,0 +1,101 @@
+#include "staticrecompilertest.h"
+#include "recompiledcode.h"
+#include "staticrecompiler.h"
+#include <QFile>
+#include <QTest>
+
+static constexpr auto AsmOrigin = 0x600;
+
+// source of recompiledroutine.cpp which is built into the tests, the loop patches the ADC # operand of its subroutine
+static const std::initializer_list<const char*> Routine{
+    "LDX #$00", "TXA", "ASL", "STA $0700,X", "JSR $0613", "INX", "STX $0615", "CPX #$20", "BNE $0602", "KIL",
+    "CLC", "ADC #$00", "ADC $10", "STA $10", "BCC $061E", "INC $11", "RTS"};
+
+StaticRecompilerTest::StaticRecompilerTest(QObject* parent)
+    : QObject(parent), assembler(memory), cpu(memory), recompiledCpu(recompiledMemory) {
+  cpu.changeEngine(CpuEngine::Threaded);
+}
+
+void StaticRecompilerTest::assemble(std::initializer_list<const char*> lines) {
+  for (const auto line : lines) QCOMPARE(assembler.processLine(line), AssemblyResult::Ok);
+}
+
+void StaticRecompilerTest::init() {
+  std::fill(memory.begin(), memory.end(), 0);
+  assembler.init(AsmOrigin);
+  assembler.changeMode(Assembler::ProcessingMode::EmitCode);
+}
+
+void StaticRecompilerTest::testBasicBlocks() {
+  assemble({"LDX #$05", "DEX", "BNE -3", "JSR $0609", "KIL", "LDA #$01", "RTS"});
+  StaticRecompiler recompiler(memory, assembler.affectedAddressRange());
+  recompiler.addEntryPoint(AsmOrigin);
+  recompiler.analyze();
+
+  const auto& blocks = recompiler.blocks();
+  QCOMPARE(blocks.size(), 5U);
+  QCOMPARE(blocks.at(0x600).range.last, 0x601);
+  QCOMPARE(blocks.at(0x602).range.last, 0x604);
+  QCOMPARE(blocks.at(0x605).range.last, 0x607);
+  QCOMPARE(blocks.at(0x608).range.last, 0x608);
+  QCOMPARE(blocks.at(0x609).range.last, 0x60b);
+  QCOMPARE(blocks.at(0x609).instructions.size(), 2U);
+}
+
+void StaticRecompilerTest::testUnresolvedJump() {
+  assemble({"LDA #$00", "JMP ($0010)", "NOP"});
+  StaticRecompiler recompiler(memory, assembler.affectedAddressRange());
+  recompiler.addEntryPoint(AsmOrigin);
+  recompiler.analyze();
+
+  QCOMPARE(recompiler.blocks().size(), 1U);
+  QCOMPARE(recompiler.blocks().at(0x600).range.last, 0x604);
+}
+
+void StaticRecompilerTest::testGeneratedSource() {
+  assemble({"LDX #$05", "DEX", "BNE -3", "JSR $0609", "KIL", "LDA #$01", "RTS"});
+  StaticRecompiler recompiler(memory, assembler.affectedAddressRange());
+  recompiler.addEntryPoint(AsmOrigin);
+  recompiler.analyze();
+
+  const auto source = recompiler.generate();
+  QVERIFY(source.contains("return 0x0600;"));
+  QVERIFY(source.contains("static void block_0602(Cpu& cpu) {\n  RecompiledCode::addCycles(cpu, 4);"));
+  QVERIFY(source.contains("RecompiledCode::exec<JSR, Absolute>(cpu, 0x0609);"));
+  QVERIFY(source.contains("case 0x0609: block_0609(cpu); return true;"));
+}
+
+void StaticRecompilerTest::testRecompiledRoutine() {
+  assemble(Routine);
+  StaticRecompiler recompiler(memory, assembler.affectedAddressRange());
+  recompiler.addEntryPoint(AsmOrigin);
+  recompiler.analyze();
+  QCOMPARE(recompiler.interpretedRanges().size(), 1U);
+  QCOMPARE(recompiler.interpretedRanges().front().first, 0x613);
+  QVERIFY(!recompiler.blocks().count(0x613));
+
+  QFile generated(QFINDTESTDATA("recompiledroutine.cpp"));
+  QVERIFY(generated.open(QIODevice::ReadOnly | QIODevice::Text));
+  QCOMPARE(recompiler.generate(), QString(generated.readAll()));
+
+  std::fill(recompiledMemory.begin(), recompiledMemory.end(), 0);
+  RecompiledCode::load(recompiledMemory);
+  QVERIFY(std::equal(memory.begin(), memory.end(), recompiledMemory.begin()));
+  cpu.reset();
+  recompiledCpu.reset();
+  cpu.regs.pc = recompiledCpu.regs.pc = RecompiledCode::entry();
+  cpu.execute(true, Duration::zero());
+  RecompiledCode::run(recompiledCpu);
+
+  QCOMPARE(memory[0x10], 0xd0);
+  QCOMPARE(memory[0x11], 0x05);
+  QCOMPARE(recompiledCpu.info().executionStatistics.cycles, cpu.info().executionStatistics.cycles);
+  QCOMPARE(recompiledCpu.info().state, cpu.info().state);
+  QCOMPARE(recompiledCpu.regs.pc, cpu.regs.pc);
+  QCOMPARE(recompiledCpu.regs.a, cpu.regs.a);
+  QCOMPARE(recompiledCpu.regs.x, cpu.regs.x);
+  QCOMPARE(recompiledCpu.regs.y, cpu.regs.y);
+  QCOMPARE(recompiledCpu.regs.sp.offset, cpu.regs.sp.offset);
+  QCOMPARE(uint8_t(recompiledCpu.regs.p), uint8_t(cpu.regs.p));
+  QVERIFY(std::equal(memory.begin(), memory.end(), recompiledMemory.begin()));
+}
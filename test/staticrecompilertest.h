@@ -0,0 +1,29 @@
+#pragma once
+
+#include "assembler.h"
+#include "cpu.h"
+#include <QObject>
+
+class StaticRecompilerTest : public QObject {
+  Q_OBJECT
+
+public:
+  explicit StaticRecompilerTest(QObject* parent = nullptr);
+
+private:
+  Assembler assembler;
+  Memory memory;
+  Memory recompiledMemory;
+  Cpu cpu;
+  Cpu recompiledCpu;
+
+  void assemble(std::initializer_list<const char*> lines);
+
+private slots:
+  void init();
+
+  void testBasicBlocks();
+  void testUnresolvedJump();
+  void testGeneratedSource();
+  void testRecompiledRoutine();
+};
@@ -0,0 +1,105 @@
+#include "variantstest.h"
+#include "cpuenginerows.h"
+#include "disassembler.h"
+#include <QTest>
+
+static constexpr auto CodeOrigin = 0x600;
+
+VariantsTest::VariantsTest(QObject* parent) : QObject(parent), cpu(memory) {
+}
+
+void VariantsTest::run(CpuVariant variant, std::initializer_list<uint8_t> code) {
+  std::copy(code.begin(), code.end(), memory.begin() + CodeOrigin);
+  cpu.changeVariant(variant);
+  cpu.regs.pc = CodeOrigin;
+  cpu.execute(true, Duration::zero());
+}
+
+void VariantsTest::initTestCase_data() {
+  addCpuEngineRows();
+}
+
+void VariantsTest::init() {
+  QFETCH_GLOBAL(CpuEngine, engine);
+  std::fill(memory.begin(), memory.end(), 0);
+  cpu.changeEngine(engine);
+  cpu.reset();
+  cpu.regs.sp.offset = 0xff;
+  cpu.regs.p = 0;
+}
+
+void VariantsTest::testNmosHaltsOnUndocumented() {
+  run(CpuVariant::Nmos, {0xa7, 0x10}); // LAX $10
+  QCOMPARE(cpu.info().state, CpuState::Halted);
+  QCOMPARE(cpu.regs.pc, CodeOrigin);
+}
+
+void VariantsTest::testUndocumentedOpcodes() {
+  memory[0x10] = 0x41;
+  memory[0x12] = 0x41;
+  memory[0x14] = 0x81;
+  run(CpuVariant::NmosUndocumented,
+      {
+          0xa7, 0x10,       // LAX $10
+          0xe8,             // INX
+          0x87, 0x11,       // SAX $11
+          0xc7, 0x12,       // DCP $12
+          0xe7, 0x13,       // ISC $13
+          0x07, 0x14,       // SLO $14
+          0x0b, 0x0f,       // ANC #$0f
+          0xcb, 0x01,       // SBX #$01
+          0x1a,             // NOP
+          0x0c, 0x00, 0x20, // NOP $2000
+          0x02,             // KIL
+      });
+
+  QCOMPARE(cpu.info().state, CpuState::Halted);
+  QCOMPARE(cpu.info().executionStatistics.cycles, 33);
+  QCOMPARE(memory[0x11], 0x40);
+  QCOMPARE(memory[0x12], 0x40);
+  QCOMPARE(memory[0x13], 0x01);
+  QCOMPARE(memory[0x14], 0x02);
+  QCOMPARE(cpu.regs.a, 0x02);
+  QCOMPARE(cpu.regs.x, 0x01);
+  QCOMPARE(uint8_t(cpu.regs.p), ProcessorStatus::CarryBitMask);
+}
+
+void VariantsTest::testCmos65C02Opcodes() {
+  memory[0x20] = 0xff;
+  memory[0x21] = 0x0f;
+  memory[0x22] = 0xf0;
+  memory.setWord(0x23, 0x0300);
+  memory[0x300] = 0x5a;
+  run(CpuVariant::Cmos65C02,
+      {
+          0xa9, 0xf0, // LDA #$f0
+          0xa2, 0x01, // LDX #$01
+          0xda,       // PHX
+          0xa2, 0x00, // LDX #$00
+          0xfa,       // PLX
+          0x1a,       // INC A
+          0x64, 0x20, // STZ $20
+          0x04, 0x21, // TSB $21
+          0x14, 0x22, // TRB $22
+          0xb2, 0x23, // LDA ($23)
+          0x80, 0x01, // BRA +1
+          0xdb,       // STP, skipped
+          0xdb,       // STP
+      });
+
+  QCOMPARE(cpu.info().state, CpuState::Halted);
+  QCOMPARE(cpu.info().executionStatistics.cycles, 39);
+  QCOMPARE(cpu.regs.pc, CodeOrigin + 20);
+  QCOMPARE(memory[0x20], 0x00);
+  QCOMPARE(memory[0x21], 0xff);
+  QCOMPARE(memory[0x22], 0x00);
+  QCOMPARE(cpu.regs.a, 0x5a);
+  QCOMPARE(cpu.regs.x, 0x01);
+}
+
+void VariantsTest::testDisassembler() {
+  memory[0] = 0xb2;
+  memory[1] = 0x23;
+  QCOMPARE(Disassembler(memory, 0, CpuVariant::Cmos65C02).disassemble().trimmed(), QString("B2 23     LDA ($23)"));
+  QCOMPARE(Disassembler(memory, 0, CpuVariant::Nmos).disassemble().trimmed(), QString("B2        KIL"));
+}
@@ -0,0 +1,26 @@
+#pragma once
+
+#include "cpu.h"
+#include <QObject>
+
+class VariantsTest : public QObject {
+  Q_OBJECT
+
+public:
+  explicit VariantsTest(QObject* parent = nullptr);
+
+private:
+  Memory memory;
+  Cpu cpu;
+
+  void run(CpuVariant variant, std::initializer_list<uint8_t> code);
+
+private slots:
+  void initTestCase_data();
+  void init();
+
+  void testNmosHaltsOnUndocumented();
+  void testUndocumentedOpcodes();
+  void testCmos65C02Opcodes();
+  void testDisassembler();
+};
@@ -0,0 +1,75 @@
+#include "writehistorytest.h"
+#include "cpuenginerows.h"
+#include <QTest>
+#include <algorithm>
+
+static constexpr auto AsmOrigin = 0x0800;
+
+WriteHistoryTest::WriteHistoryTest(QObject* parent) : QObject(parent), assembler(memory), cpu(memory) {
+}
+
+void WriteHistoryTest::run() {
+  cpu.regs.pc = AsmOrigin;
+  cpu.regs.sp.offset = 0xff;
+  cpu.execute(true, Duration::zero());
+}
+
+// a byte of the frame buffer written by two instructions, then eight pushes
+void WriteHistoryTest::init() {
+  std::fill(memory.begin(), memory.end(), 0);
+  assembler.init(AsmOrigin);
+  assembler.changeMode(Assembler::ProcessingMode::EmitCode);
+  for (const auto line : {"LDA #$11", "STA $0210", "INC $0210", "LDX #$08", "PHA", "DEX", "BNE $080A", "KIL"})
+    QCOMPARE(assembler.processLine(line), AssemblyResult::Ok);
+  memory[0x0210] = 0x05;
+  cpu.changeEngine(CpuEngine::Threaded);
+  cpu.reset();
+}
+
+void WriteHistoryTest::testOldestWritesDropped() {
+  cpu.changeWriteHistory(8);
+  run();
+  const auto& history = cpu.writeHistory();
+  QCOMPARE(history.size(), size_t(8));
+  QCOMPARE(history.writesTo({0x0100, 0x01ff}, 0, cycles()).size(), size_t(8));
+  QVERIFY(history.writesTo(0x0210, 0, cycles()).empty());
+  QVERIFY(!history.lastWrite(0x0210));
+}
+
+void WriteHistoryTest::testLastWriteAndWindow() {
+  cpu.changeWriteHistory(1024);
+  run();
+  const auto& history = cpu.writeHistory();
+  const auto last = history.lastWrite(0x0210);
+  QVERIFY(last);
+  QCOMPARE(last->pc, 0x0805);
+  QCOMPARE(last->oldValue, 0x11);
+  QCOMPARE(last->newValue, 0x12);
+  const auto writes = history.writesTo(0x0210, 0, cycles());
+  QCOMPARE(writes.size(), size_t(2));
+  QCOMPARE(writes.front().pc, 0x0802);
+  QCOMPARE(writes.front().oldValue, 0x05);
+  QCOMPARE(history.writesTo(0x0210, writes.back().cycle, cycles()).size(), size_t(1));
+  QVERIFY(history.writesTo(0x0210, writes.back().cycle + 1, cycles()).empty());
+  QVERIFY(history.writesTo(0x0210, 0, writes.front().cycle - 1).empty());
+}
+
+void WriteHistoryTest::testWritesLoggedByEngine_data() {
+  addCpuEngineRows();
+}
+
+// every engine logs through its bus, the cycle exact engine logs the dummy write of INC as well
+void WriteHistoryTest::testWritesLoggedByEngine() {
+  QFETCH(CpuEngine, engine);
+  cpu.changeEngine(engine);
+  cpu.changeWriteHistory(1024);
+  run();
+  const auto& history = cpu.writeHistory();
+  const auto writes = history.writesTo(0x0210, 0, cycles());
+  QCOMPARE(writes.size(), size_t(engine == CpuEngine::CycleExact ? 3 : 2));
+  QCOMPARE(writes.front().pc, 0x0802);
+  QCOMPARE(writes.back().pc, 0x0805);
+  QCOMPARE(writes.back().newValue, 0x12);
+  QCOMPARE(history.writesTo({0x0100, 0x01ff}, 0, cycles()).size(), size_t(8));
+  cpu.changeWriteHistory(0);
+}
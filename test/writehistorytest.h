@@ -0,0 +1,28 @@
+#pragma once
+
+#include "assembler.h"
+#include "cpu.h"
+#include <QObject>
+
+class WriteHistoryTest : public QObject {
+  Q_OBJECT
+
+public:
+  explicit WriteHistoryTest(QObject* parent = nullptr);
+
+private:
+  Assembler assembler;
+  Memory memory;
+  Cpu cpu;
+
+  void run();
+  long cycles() const { return cpu.info().executionStatistics.cycles; }
+
+private slots:
+  void init();
+
+  void testOldestWritesDropped();
+  void testLastWriteAndWindow();
+  void testWritesLoggedByEngine_data();
+  void testWritesLoggedByEngine();
+};
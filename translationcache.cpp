@@ -0,0 +1,58 @@
+#include "translationcache.h"
+#include "memory.h"
+#include <algorithm>
+
+TranslationCache::TranslationCache() : blocks(Memory::Size), hits(Memory::Size) {
+}
+
+void TranslationCache::insert(std::unique_ptr<TranslatedBlock> block) {
+  updatePageBlocks(*block, 1);
+  starts.push_back(block->first);
+  blocks[block->first] = std::move(block);
+}
+
+void TranslationCache::invalidate(Address addr) {
+  const auto lowest = std::max(0, addr - static_cast<int>(MaxInstructions * 3));
+  for (int first = addr; first >= lowest; first--) {
+    if (auto& block = blocks[static_cast<Address>(first)]; block && block->valid && block->last >= addr) {
+      block->valid = false;
+      hits[block->first] = 0;
+      updatePageBlocks(*block, -1);
+      invalidated = true;
+    }
+  }
+}
+
+void TranslationCache::invalidate(AddressRange range) {
+  for (const auto first : starts) {
+    if (auto& block = blocks[first]; block->valid && block->first <= range.last && block->last >= range.first) {
+      block->valid = false;
+      hits[first] = 0;
+      updatePageBlocks(*block, -1);
+      invalidated = true;
+    }
+  }
+}
+
+void TranslationCache::purge() {
+  if (!invalidated) return;
+  const auto it = std::remove_if(starts.begin(), starts.end(), [&](Address first) {
+    if (blocks[first]->valid) return false;
+    blocks[first].reset();
+    return true;
+  });
+  starts.erase(it, starts.end());
+  invalidated = false;
+}
+
+void TranslationCache::clear() {
+  for (const auto first : starts) blocks[first].reset();
+  starts.clear();
+  std::fill(hits.begin(), hits.end(), 0);
+  pageBlocks.fill(0);
+  invalidated = false;
+}
+
+void TranslationCache::updatePageBlocks(const TranslatedBlock& block, int delta) {
+  for (auto page = block.first >> 8; page <= block.last >> 8; page++) pageBlocks[page] += delta;
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include "addressrange.h"
+#include "commondefs.h"
+#include "nativeroutine.h"
+#include <array>
+#include <memory>
+#include <vector>
+
+class Cpu;
+
+struct TranslatedInstruction {
+  void (Cpu::*handler)(uint16_t);
+  uint16_t operand;
+  uint16_t elapsedCycles;
+};
+
+struct TranslatedBlock {
+  Address first;
+  Address last;
+  long cycles = 0;
+  bool valid = true;
+  std::vector<TranslatedInstruction> instructions;
+  std::unique_ptr<NativeRoutine> routine;
+};
+
+class TranslationCache {
+public:
+  static constexpr uint8_t HotThreshold = 16;
+  static constexpr uint8_t Untranslatable = 0xff;
+  static constexpr size_t MaxInstructions = 64;
+
+  TranslationCache();
+
+  TranslatedBlock* find(Address addr) const { return blocks[addr].get(); }
+  bool covers(Address addr) const { return pageBlocks[addr >> 8]; }
+  bool hot(Address addr) { return hits[addr] != Untranslatable && ++hits[addr] >= HotThreshold; }
+  void markUntranslatable(Address addr) { hits[addr] = Untranslatable; }
+  void insert(std::unique_ptr<TranslatedBlock>);
+  void invalidate(Address addr);
+  void invalidate(AddressRange);
+  void purge();
+  void clear();
+
+private:
+  std::vector<std::unique_ptr<TranslatedBlock>> blocks;
+  std::vector<uint8_t> hits;
+  std::array<uint16_t, 0x100> pageBlocks{};
+  std::vector<Address> starts;
+  bool invalidated = false;
+
+  void updatePageBlocks(const TranslatedBlock&, int delta);
+};
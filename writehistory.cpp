@@ -0,0 +1,71 @@
+#include "writehistory.h"
+#include "memory.h"
+
+void WriteHistory::changeCapacity(size_t capacity) {
+  size_t rounded = capacity ? 1 : 0;
+  while (rounded && rounded < capacity) rounded *= 2;
+  writes.assign(rounded, {});
+  mask = rounded - 1;
+  lastWrites.assign(capacity ? Memory::Size : 0, 0);
+  total = 0;
+  oldestWrite = 1;
+}
+
+void WriteHistory::clear() {
+  std::fill(lastWrites.begin(), lastWrites.end(), 0);
+  total = 0;
+  oldestWrite = 1;
+}
+
+// Drops writes done at or after the cycle, the run goes on from there in another way
+void WriteHistory::truncate(long cycle) {
+  if (!enabled()) return;
+  while (total >= oldestWrite && at(total).cycle >= cycle) {
+    lastWrites[at(total).address] = at(total).previous;
+    total--;
+  }
+}
+
+std::optional<WriteHistory::Write> WriteHistory::lastWrite(Address address) const {
+  if (!enabled() || lastWrites[address] < oldestWrite) return std::nullopt;
+  return at(lastWrites[address]);
+}
+
+// first write done at or after the cycle, writes are in cycle order
+uint64_t WriteHistory::firstFrom(long cycle) const {
+  auto low = oldestWrite;
+  auto high = total + 1;
+  while (low < high) {
+    const auto middle = low + (high - low) / 2;
+    if (at(middle).cycle < cycle)
+      low = middle + 1;
+    else
+      high = middle;
+  }
+  return low;
+}
+
+// Writes in the cycle window are either scanned or reached through the links of each address, whichever passes fewer
+// writes: links are followed until they have cost as much as the scan would.
+std::vector<WriteHistory::Write> WriteHistory::writesTo(AddressRange range, long fromCycle, long toCycle) const {
+  std::vector<Write> found;
+  if (!enabled() || !range.valid() || fromCycle > toCycle) return found;
+  const auto first = firstFrom(fromCycle);
+  const auto end = toCycle == std::numeric_limits<long>::max() ? total + 1 : firstFrom(toCycle + 1);
+  auto budget = end - first;
+  std::vector<uint64_t> numbers;
+  for (auto address = static_cast<int>(range.first); address <= range.last && budget; address++) {
+    for (auto number = lastWrites[static_cast<size_t>(address)]; number >= first && budget; number = at(number).previous) {
+      budget--;
+      if (number < end) numbers.push_back(number);
+    }
+  }
+  if (budget) {
+    std::sort(numbers.begin(), numbers.end());
+    for (const auto number : numbers) found.push_back(at(number));
+  } else {
+    for (auto number = first; number < end; number++)
+      if (range.contains(at(number).address)) found.push_back(at(number));
+  }
+  return found;
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include "addressrange.h"
+#include "commondefs.h"
+#include <limits>
+#include <optional>
+#include <vector>
+
+// The last writes done by the processor, oldest overwritten first. Every write links to the previous write to the same
+// address and the last write to each address is kept, so the writes to an address are found without looking at any
+// other. Writes are numbered from 1 in the order they were done, 0 links to nothing. The capacity is rounded up to a
+// power of two.
+class WriteHistory {
+public:
+  struct Write {
+    long cycle;        // instruction start, or the bus cycle of the write with the cycle exact engine
+    uint64_t previous; // number of the previous write to the address
+    Address pc;        // instruction doing the write
+    Address address;
+    uint8_t oldValue;
+    uint8_t newValue;
+  };
+
+  bool enabled() const { return !writes.empty(); }
+  size_t capacity() const { return writes.size(); }
+  void changeCapacity(size_t);
+  size_t size() const { return static_cast<size_t>(total + 1 - oldestWrite); }
+  void clear();
+  void truncate(long cycle);
+
+  void add(long cycle, Address pc, Address address, uint8_t oldValue, uint8_t newValue) {
+    writes[total & mask] = {cycle, lastWrites[address], pc, address, oldValue, newValue};
+    lastWrites[address] = ++total;
+    if (total - oldestWrite == writes.size()) oldestWrite++;
+  }
+
+  std::optional<Write> lastWrite(Address) const;
+  std::vector<Write> writesTo(AddressRange, long fromCycle, long toCycle) const;
+
+private:
+  std::vector<Write> writes;
+  std::vector<uint64_t> lastWrites;
+  uint64_t total = 0; // number of the last write
+  uint64_t oldestWrite = 1;
+  uint64_t mask = 0;
+
+  const Write& at(uint64_t number) const { return writes[(number - 1) & mask]; }
+  uint64_t firstFrom(long cycle) const;
+};